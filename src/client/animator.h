@@ -50,6 +50,7 @@ public:
 
     void setPhase(int phase);
     int getPhase();
+    ticks_t getNextPhaseTime() { return m_isComplete ? std::numeric_limits<ticks_t>::max() : m_lastPhaseTicks + m_currentDuration; }
     int getPhaseAt(ticks_t time);
 
     int getStartPhase();
@@ -29,6 +29,8 @@
 #include "shadermanager.h"
 #include "spritemanager.h"
 #include "minimap.h"
+#include "outfitcache.h"
+#include "creatureanimator.h"
 #include <framework/core/configmanager.h>
 
 Client g_client;
@@ -43,6 +45,7 @@ void Client::init(std::vector<std::string>& args)
     g_game.init();
     g_shaders.init();
     g_things.init();
+    g_outfitCache.init();
 
     //TODO: restore options
 /*
@@ -83,6 +86,8 @@ void Client::init(std::vector<std::string>& args)
 
 void Client::terminate()
 {
+    g_creatureAnimator.terminate();
+    g_outfitCache.terminate();
     g_creatures.terminate();
     g_game.terminate();
     g_map.terminate();
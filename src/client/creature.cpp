@@ -30,15 +30,19 @@
 #include "effect.h"
 #include "luavaluecasts.h"
 #include "lightview.h"
+#include "outfitcache.h"
+#include "creatureanimator.h"
 
 #include <framework/graphics/graphics.h>
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/clock.h>
+#include <framework/core/application.h>
 
 #include <framework/graphics/paintershaderprogram.h>
 #include <framework/graphics/ogl/painterogl2_shadersources.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/graphics/framebuffermanager.h>
+#include <framework/graphics/framebuffer.h>
 #include "spritemanager.h"
 
 Creature::Creature() : Thing()
@@ -61,6 +65,10 @@ Creature::Creature() : Thing()
     m_footStep = 0;
     m_speedFormula.fill(-1);
     m_outfitColor = Color::white;
+    m_outfitColorDuration = 0;
+    m_jumpHeight = 0;
+    m_jumpDuration = 0;
+    m_animationIndex = -1;
 }
 
 void Creature::draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView)
@@ -98,7 +106,7 @@ void Creature::draw(const Point& dest, float scaleFactor, bool animate, LightVie
         }
 
         if(light.intensity > 0)
-            lightView->addLightSource(dest + (animationOffset + Point(16,16)) * scaleFactor, scaleFactor, light);
+            lightView->addLightSource(dest + (animationOffset + Point(16,16)) * scaleFactor, scaleFactor, light, true);
     }
 }
 
@@ -109,10 +117,14 @@ void Creature::internalDrawOutfit(Point dest, float scaleFactor, bool animateWal
     // outfit is a real creature
     if(m_outfit.getCategory() == ThingCategoryCreature) {
         int animationPhase = animateWalk ? m_walkAnimationPhase : 0;
+        if(animateWalk && m_walking)
+            g_map.scheduleAnimationFrame(g_clock.millis());
 
         if(isAnimateAlways() && animateIdle) {
             int ticksPerFrame = 1000 / getAnimationPhases();
-            animationPhase = (g_clock.millis() % (ticksPerFrame * getAnimationPhases())) / ticksPerFrame;
+            ticks_t ticks = g_clock.millis();
+            animationPhase = (ticks % (ticksPerFrame * getAnimationPhases())) / ticksPerFrame;
+            g_map.scheduleAnimationFrame(ticks - ticks % ticksPerFrame + ticksPerFrame);
         }
 
         // xPattern => creature direction
@@ -124,44 +136,22 @@ void Creature::internalDrawOutfit(Point dest, float scaleFactor, bool animateWal
         else
             xPattern = direction;
 
-        int zPattern = 0;
-        if(m_outfit.getMount() != 0) {
-            auto datType = g_things.rawGetThingType(m_outfit.getMount(), ThingCategoryCreature);
-            dest -= datType->getDisplacement() * scaleFactor;
-            datType->draw(dest, scaleFactor, 0, xPattern, 0, 0, animationPhase, lightView);
-            dest += getDisplacement() * scaleFactor;
-            zPattern = std::min<int>(1, getNumPatternZ() - 1);
-        }
-
-        PointF jumpOffset = m_jumpOffset * scaleFactor;
-        dest -= Point(stdext::round(jumpOffset.x), stdext::round(jumpOffset.y));
-
-        // yPattern => creature addon
-        for(int yPattern = 0; yPattern < getNumPatternY(); yPattern++) {
-
-            // continue if we dont have this addon
-            if(yPattern > 0 && !(m_outfit.getAddons() & (1 << (yPattern-1))))
-                continue;
-
-            auto datType = rawGetThingType();
-            datType->draw(dest, scaleFactor, 0, xPattern, yPattern, zPattern, animationPhase, yPattern == 0 ? lightView : nullptr);
-
-            if(getLayers() > 1) {
-                Color oldColor = g_painter->getColor();
-                Painter::CompositionMode oldComposition = g_painter->getCompositionMode();
-                g_painter->setCompositionMode(Painter::CompositionMode_Multiply);
-                g_painter->setColor(m_outfit.getHeadColor());
-                datType->draw(dest, scaleFactor, SpriteMaskYellow, xPattern, yPattern, zPattern, animationPhase);
-                g_painter->setColor(m_outfit.getBodyColor());
-                datType->draw(dest, scaleFactor, SpriteMaskRed, xPattern, yPattern, zPattern, animationPhase);
-                g_painter->setColor(m_outfit.getLegsColor());
-                datType->draw(dest, scaleFactor, SpriteMaskGreen, xPattern, yPattern, zPattern, animationPhase);
-                g_painter->setColor(m_outfit.getFeetColor());
-                datType->draw(dest, scaleFactor, SpriteMaskBlue, xPattern, yPattern, zPattern, animationPhase);
-                g_painter->setColor(oldColor);
-                g_painter->setCompositionMode(oldComposition);
+        // composited outfits are drawn at once, as long as nothing of them is drawn elsewhere
+        if(g_outfitCache.isEnabled() && m_jumpOffset.isNull() && canCacheOutfit(animationPhase)) {
+            const Point frameDest(OutfitCache::FRAME_SIZE - Otc::TILE_PIXELS, OutfitCache::FRAME_SIZE - Otc::TILE_PIXELS);
+            bool created;
+            const FrameBufferPtr& frame = g_outfitCache.getFrame(m_outfit, xPattern, animationPhase, created);
+            if(created) {
+                frame->bind();
+                g_painter->setAlphaWriting(true);
+                g_painter->clear(Color::alpha);
+                internalDrawOutfitLayers(frameDest, 1, xPattern, animationPhase);
+                frame->release();
             }
-        }
+            frame->draw(Rect(dest - frameDest * scaleFactor, Size(OutfitCache::FRAME_SIZE, OutfitCache::FRAME_SIZE) * scaleFactor),
+                        Rect(0, 0, OutfitCache::FRAME_SIZE, OutfitCache::FRAME_SIZE));
+        } else
+            internalDrawOutfitLayers(dest, scaleFactor, xPattern, animationPhase, lightView);
     // outfit is a creature imitating an item or the invisible effect
     } else  {
         ThingType *type = g_things.rawGetThingType(m_outfit.getAuxId(), m_outfit.getCategory());
@@ -178,9 +168,11 @@ void Creature::internalDrawOutfit(Point dest, float scaleFactor, bool animateWal
         }
 
         if(animationPhases > 1) {
-            if(animateIdle)
-                animationPhase = (g_clock.millis() % (animateTicks * animationPhases)) / animateTicks;
-            else
+            if(animateIdle) {
+                ticks_t ticks = g_clock.millis();
+                animationPhase = (ticks % (animateTicks * animationPhases)) / animateTicks;
+                g_map.scheduleAnimationFrame(ticks - ticks % animateTicks + animateTicks);
+            } else
                 animationPhase = animationPhases-1;
         }
 
@@ -193,6 +185,48 @@ void Creature::internalDrawOutfit(Point dest, float scaleFactor, bool animateWal
     g_painter->resetColor();
 }
 
+void Creature::internalDrawOutfitLayers(Point dest, float scaleFactor, int xPattern, int animationPhase, LightView *lightView)
+{
+    int zPattern = 0;
+    if(m_outfit.getMount() != 0) {
+        auto datType = g_things.rawGetThingType(m_outfit.getMount(), ThingCategoryCreature);
+        dest -= datType->getDisplacement() * scaleFactor;
+        datType->draw(dest, scaleFactor, 0, xPattern, 0, 0, animationPhase, lightView);
+        dest += getDisplacement() * scaleFactor;
+        zPattern = std::min<int>(1, getNumPatternZ() - 1);
+    }
+
+    PointF jumpOffset = m_jumpOffset * scaleFactor;
+    dest -= Point(stdext::round(jumpOffset.x), stdext::round(jumpOffset.y));
+
+    // yPattern => creature addon
+    for(int yPattern = 0; yPattern < getNumPatternY(); yPattern++) {
+
+        // continue if we dont have this addon
+        if(yPattern > 0 && !(m_outfit.getAddons() & (1 << (yPattern-1))))
+            continue;
+
+        rawGetThingType()->drawOutfit(dest, scaleFactor, xPattern, yPattern, zPattern, animationPhase, m_outfit, yPattern == 0 ? lightView : nullptr);
+    }
+}
+
+bool Creature::canCacheOutfit(int animationPhase)
+{
+    // frames are cached only once all their textures are loaded, and lights must still reach the light view
+    ThingType *outfitType = rawGetThingType();
+    if(outfitType->isNull() || outfitType->hasLight() || animationPhase >= outfitType->getAnimationPhases() || !outfitType->isTextureLoaded(animationPhase))
+        return false;
+
+    if(m_outfit.getMount() != 0) {
+        ThingType *mountType = g_things.rawGetThingType(m_outfit.getMount(), ThingCategoryCreature);
+        if(mountType->isNull() || mountType->hasLight())
+            return false;
+        if(animationPhase < mountType->getAnimationPhases() && !mountType->isTextureLoaded(animationPhase))
+            return false;
+    }
+    return true;
+}
+
 void Creature::drawOutfit(const Rect& destRect, bool resize)
 {
     int exactSize;
@@ -380,47 +414,24 @@ void Creature::jump(int height, int duration)
     m_jumpHeight = height;
     m_jumpDuration = duration;
 
-    updateJump();
+    if(updateJump())
+        g_creatureAnimator.addAnimation(static_self_cast<Creature>(), CreatureAnimator::AnimationJump);
 }
 
-void Creature::updateJump()
+bool Creature::updateJump()
 {
     int t = m_jumpTimer.ticksElapsed();
+    if(t >= m_jumpDuration) {
+        m_jumpOffset = PointF(0, 0);
+        return false;
+    }
+
     double a = -4 * m_jumpHeight / (m_jumpDuration * m_jumpDuration);
     double b = +4 * m_jumpHeight / (m_jumpDuration);
 
     double height = a*t*t + b*t;
-    int roundHeight = stdext::round(height);
-    int halfJumpDuration = m_jumpDuration / 2;
-
-    // schedules next update
-    if(m_jumpTimer.ticksElapsed() < m_jumpDuration) {
-        m_jumpOffset = PointF(height, height);
-
-        int diff = 0;
-        if(m_jumpTimer.ticksElapsed() < halfJumpDuration)
-            diff = 1;
-        else if(m_jumpTimer.ticksElapsed() > halfJumpDuration)
-            diff = -1;
-
-        int nextT, i = 1;
-        do {
-            nextT = stdext::round((-b + std::sqrt(std::max<double>(b*b + 4*a*(roundHeight+diff*i), 0.0)) * diff) / (2*a));
-            ++i;
-
-            if(nextT < halfJumpDuration)
-                diff = 1;
-            else if(nextT > halfJumpDuration)
-                diff = -1;
-        } while(nextT - m_jumpTimer.ticksElapsed() == 0 && i < 3);
-
-        auto self = static_self_cast<Creature>();
-        g_dispatcher.scheduleEvent([self] {
-            self->updateJump();
-        }, nextT - m_jumpTimer.ticksElapsed());
-    }
-    else
-        m_jumpOffset = PointF(0, 0);
+    m_jumpOffset = PointF(height, height);
+    return true;
 }
 
 void Creature::onPositionChange(const Position& newPos, const Position& oldPos)
@@ -566,21 +577,12 @@ void Creature::updateWalkingTile()
 
 void Creature::nextWalkUpdate()
 {
-    // remove any previous scheduled walk updates
-    if(m_walkUpdateEvent)
-        m_walkUpdateEvent->cancel();
-
     // do the update
     updateWalk();
 
-    // schedules next update
-    if(m_walking) {
-        auto self = static_self_cast<Creature>();
-        m_walkUpdateEvent = g_dispatcher.scheduleEvent([self] {
-            self->m_walkUpdateEvent = nullptr;
-            self->nextWalkUpdate();
-        }, getStepDuration(true) / Otc::TILE_PIXELS);
-    }
+    // keeps updating every frame until the walk ends
+    if(m_walking)
+        g_creatureAnimator.addAnimation(static_self_cast<Creature>(), CreatureAnimator::AnimationWalk);
 }
 
 void Creature::updateWalk()
@@ -603,11 +605,7 @@ void Creature::updateWalk()
 
 void Creature::terminateWalk()
 {
-    // remove any scheduled walk update
-    if(m_walkUpdateEvent) {
-        m_walkUpdateEvent->cancel();
-        m_walkUpdateEvent = nullptr;
-    }
+    // the walk animation is dropped by the animator once it sees the walk has ended
 
     // now the walk has ended, do any scheduled turn
     if(m_walkTurnDirection != Otc::InvalidDirection)  {
@@ -632,6 +630,7 @@ void Creature::setName(const std::string& name)
 {
     m_nameCache.setText(name);
     m_name = name;
+    g_app.repaintBackground();
 }
 
 void Creature::setHealthPercent(uint8 healthPercent)
@@ -650,6 +649,7 @@ void Creature::setHealthPercent(uint8 healthPercent)
         m_informationColor = Color(0x85, 0x0C, 0x0C);
 
     m_healthPercent = healthPercent;
+    g_app.repaintBackground();
     callLuaField("onHealthPercentChange", healthPercent);
 
     if(healthPercent <= 0)
@@ -660,6 +660,7 @@ void Creature::setDirection(Otc::Direction direction)
 {
     assert(direction != Otc::InvalidDirection);
     m_direction = direction;
+    g_app.repaintBackground();
 }
 
 void Creature::setOutfit(const Outfit& outfit)
@@ -676,39 +677,36 @@ void Creature::setOutfit(const Outfit& outfit)
         m_outfit = outfit;
     }
     m_walkAnimationPhase = 0; // might happen when player is walking and outfit is changed.
+    g_app.repaintBackground();
 
     callLuaField("onOutfitChange", m_outfit, oldOutfit);
 }
 
 void Creature::setOutfitColor(const Color& color, int duration)
 {
-    if(m_outfitColorUpdateEvent) {
-        m_outfitColorUpdateEvent->cancel();
-        m_outfitColorUpdateEvent = nullptr;
-    }
-
     if(duration > 0) {
-        Color delta = (color - m_outfitColor) / (float)duration;
+        m_outfitColorStart = m_outfitColor;
+        m_outfitColorFinal = color;
+        m_outfitColorDuration = duration;
         m_outfitColorTimer.restart();
-        updateOutfitColor(m_outfitColor, color, delta, duration);
-    }
-    else
+        g_creatureAnimator.addAnimation(static_self_cast<Creature>(), CreatureAnimator::AnimationOutfitColor);
+    } else {
+        g_creatureAnimator.removeAnimation(static_self_cast<Creature>(), CreatureAnimator::AnimationOutfitColor);
         m_outfitColor = color;
+        g_app.repaintBackground();
+    }
 }
 
-void Creature::updateOutfitColor(Color color, Color finalColor, Color delta, int duration)
+bool Creature::updateOutfitColor()
 {
-    if(m_outfitColorTimer.ticksElapsed() < duration) {
-        m_outfitColor = color + delta * m_outfitColorTimer.ticksElapsed();
-
-        auto self = static_self_cast<Creature>();
-        m_outfitColorUpdateEvent = g_dispatcher.scheduleEvent([=] {
-            self->updateOutfitColor(color, finalColor, delta, duration);
-        }, 100);
-    }
-    else {
-        m_outfitColor = finalColor;
+    int elapsed = m_outfitColorTimer.ticksElapsed();
+    if(elapsed >= m_outfitColorDuration) {
+        m_outfitColor = m_outfitColorFinal;
+        return false;
     }
+
+    m_outfitColor = m_outfitColorStart + (m_outfitColorFinal - m_outfitColorStart) * (elapsed / (float)m_outfitColorDuration);
+    return true;
 }
 
 void Creature::setSpeed(uint16 speed)
@@ -766,6 +764,7 @@ void Creature::setIcon(uint8 icon)
 void Creature::setSkullTexture(const std::string& filename)
 {
     m_skullTexture = g_textures.getTexture(filename);
+    g_app.repaintBackground();
 }
 
 void Creature::setShieldTexture(const std::string& filename, bool blink)
@@ -781,21 +780,25 @@ void Creature::setShieldTexture(const std::string& filename, bool blink)
     }
 
     m_shieldBlink = blink;
+    g_app.repaintBackground();
 }
 
 void Creature::setEmblemTexture(const std::string& filename)
 {
     m_emblemTexture = g_textures.getTexture(filename);
+    g_app.repaintBackground();
 }
 
 void Creature::setTypeTexture(const std::string& filename)
 {
     m_typeTexture = g_textures.getTexture(filename);
+    g_app.repaintBackground();
 }
 
 void Creature::setIconTexture(const std::string& filename)
 {
     m_iconTexture = g_textures.getTexture(filename);
+    g_app.repaintBackground();
 }
 
 void Creature::setSpeedFormula(double speedA, double speedB, double speedC)
@@ -815,6 +818,7 @@ void Creature::addTimedSquare(uint8 color)
 {
     m_showTimedSquare = true;
     m_timedSquareColor = Color::from8bit(color);
+    g_app.repaintBackground();
 
     // schedule removal
     auto self = static_self_cast<Creature>();
@@ -835,6 +839,32 @@ void Creature::updateShield()
     }
     else if(!m_shieldBlink)
         m_showShieldTexture = true;
+    g_app.repaintBackground();
+}
+
+void Creature::setLight(const Light& light)
+{
+    m_light = light;
+    g_app.repaintBackground();
+}
+
+void Creature::removeTimedSquare()
+{
+    m_showTimedSquare = false;
+    g_app.repaintBackground();
+}
+
+void Creature::showStaticSquare(const Color& color)
+{
+    m_showStaticSquare = true;
+    m_staticSquareColor = color;
+    g_app.repaintBackground();
+}
+
+void Creature::hideStaticSquare()
+{
+    m_showStaticSquare = false;
+    g_app.repaintBackground();
 }
 
 Point Creature::getDrawOffset()
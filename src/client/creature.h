@@ -47,6 +47,8 @@ public:
     virtual void draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView = nullptr);
 
     void internalDrawOutfit(Point dest, float scaleFactor, bool animateWalk, bool animateIdle, Otc::Direction direction, LightView *lightView = nullptr);
+    void internalDrawOutfitLayers(Point dest, float scaleFactor, int xPattern, int animationPhase, LightView *lightView = nullptr);
+    bool canCacheOutfit(int animationPhase);
     void drawOutfit(const Rect& destRect, bool resize);
     void drawInformation(const Point& point, bool useGray, const Rect& parentRect, int drawFlags);
 
@@ -56,7 +58,7 @@ public:
     void setDirection(Otc::Direction direction);
     void setOutfit(const Outfit& outfit);
     void setOutfitColor(const Color& color, int duration);
-    void setLight(const Light& light) { m_light = light; }
+    void setLight(const Light& light);
     void setSpeed(uint16 speed);
     void setBaseSpeed(double baseSpeed);
     void setSkull(uint8 skull);
@@ -73,10 +75,10 @@ public:
     void setSpeedFormula(double speedA, double speedB, double speedC);
 
     void addTimedSquare(uint8 color);
-    void removeTimedSquare() { m_showTimedSquare = false; }
+    void removeTimedSquare();
 
-    void showStaticSquare(const Color& color) { m_showStaticSquare = true; m_staticSquareColor = color; }
-    void hideStaticSquare() { m_showStaticSquare = false; }
+    void showStaticSquare(const Color& color);
+    void hideStaticSquare();
 
     uint32 getId() { return m_id; }
     std::string getName() { return m_name; }
@@ -142,8 +144,8 @@ protected:
     virtual void updateWalk();
     virtual void terminateWalk();
 
-    void updateOutfitColor(Color color, Color finalColor, Color delta, int duration);
-    void updateJump();
+    bool updateOutfitColor();
+    bool updateJump();
 
     uint32 m_id;
     std::string m_name;
@@ -174,7 +176,9 @@ protected:
     CachedText m_nameCache;
     Color m_informationColor;
     Color m_outfitColor;
-    ScheduledEventPtr m_outfitColorUpdateEvent;
+    Color m_outfitColorStart;
+    Color m_outfitColorFinal;
+    int m_outfitColorDuration;
     Timer m_outfitColorTimer;
 
     std::array<double, Otc::LastSpeedFormula> m_speedFormula;
@@ -189,7 +193,6 @@ protected:
     stdext::boolean<false> m_walking;
     stdext::boolean<false> m_allowAppearWalk;
     stdext::boolean<false> m_footStepDrawn;
-    ScheduledEventPtr m_walkUpdateEvent;
     ScheduledEventPtr m_walkFinishAnimEvent;
     EventPtr m_disappearEvent;
     Point m_walkOffset;
@@ -204,6 +207,10 @@ protected:
     float m_jumpDuration;
     PointF m_jumpOffset;
     Timer m_jumpTimer;
+
+    int m_animationIndex;
+
+    friend class CreatureAnimator;
 };
 
 // @bindclass
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "creatureanimator.h"
+#include "creature.h"
+#include <framework/core/eventdispatcher.h>
+#include <framework/core/application.h>
+
+CreatureAnimator g_creatureAnimator;
+
+void CreatureAnimator::terminate()
+{
+    if(m_updateEvent) {
+        m_updateEvent->cancel();
+        m_updateEvent = nullptr;
+    }
+
+    for(CreatureAnimation& animation : m_animations)
+        animation.creature->m_animationIndex = -1;
+    m_animations.clear();
+}
+
+void CreatureAnimator::addAnimation(const CreaturePtr& creature, Animation animation)
+{
+    int index = creature->m_animationIndex;
+    if(index < 0) {
+        index = m_animations.size();
+        m_animations.push_back({ creature, 0 });
+        creature->m_animationIndex = index;
+    }
+    m_animations[index].animations |= animation;
+
+    // a single cycle event runs once every poll while there is something to animate
+    if(!m_updateEvent)
+        m_updateEvent = g_dispatcher.cycleEvent([this] { update(); }, 1);
+}
+
+void CreatureAnimator::removeAnimation(const CreaturePtr& creature, Animation animation)
+{
+    // the entry itself is dropped in the next update
+    int index = creature->m_animationIndex;
+    if(index >= 0)
+        m_animations[index].animations &= ~animation;
+}
+
+void CreatureAnimator::update()
+{
+    // animations started while updating are advanced in the next frame only
+    uint count = m_animations.size();
+    if(count > 0)
+        g_app.repaintBackground();
+    for(uint i = 0; i < count; ++i) {
+        Creature *creature = m_animations[i].creature.get();
+        uint8 animations = m_animations[i].animations;
+        uint8 finished = 0;
+
+        if(animations & AnimationWalk) {
+            if(creature->isWalking())
+                creature->updateWalk();
+            if(!creature->isWalking())
+                finished |= AnimationWalk;
+        }
+
+        if((animations & AnimationJump) && !creature->updateJump())
+            finished |= AnimationJump;
+
+        if((animations & AnimationOutfitColor) && !creature->updateOutfitColor())
+            finished |= AnimationOutfitColor;
+
+        // the vector may have grown while updating, so the entry is looked up again
+        m_animations[i].animations &= ~finished;
+    }
+
+    // drop creatures without animations, keeping the others contiguous
+    uint size = 0;
+    for(uint i = 0; i < m_animations.size(); ++i) {
+        if(m_animations[i].animations == 0) {
+            m_animations[i].creature->m_animationIndex = -1;
+            continue;
+        }
+        if(i != size) {
+            m_animations[size] = std::move(m_animations[i]);
+            m_animations[size].creature->m_animationIndex = size;
+        }
+        ++size;
+    }
+    m_animations.resize(size);
+
+    // the cycle event can't be canceled from its own callback
+    if(m_animations.empty()) {
+        g_dispatcher.addEvent([this] {
+            if(m_animations.empty() && m_updateEvent) {
+                m_updateEvent->cancel();
+                m_updateEvent = nullptr;
+            }
+        });
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef CREATUREANIMATOR_H
+#define CREATUREANIMATOR_H
+
+#include "declarations.h"
+#include <framework/core/declarations.h>
+
+// @bindsingleton g_creatureAnimator
+class CreatureAnimator
+{
+public:
+    enum Animation : uint8 {
+        AnimationWalk = 1,
+        AnimationJump = 2,
+        AnimationOutfitColor = 4
+    };
+
+    void terminate();
+
+    /// Advances the animations of all creatures once per frame, a creature is kept
+    /// referenced until its last animation ends
+    void addAnimation(const CreaturePtr& creature, Animation animation);
+    void removeAnimation(const CreaturePtr& creature, Animation animation);
+    void update();
+
+    int getAnimatedCreatures() { return m_animations.size(); }
+
+private:
+    struct CreatureAnimation {
+        CreaturePtr creature;
+        uint8 animations;
+    };
+
+    std::vector<CreatureAnimation> m_animations;
+    ScheduledEventPtr m_updateEvent;
+};
+
+extern CreatureAnimator g_creatureAnimator;
+
+#endif
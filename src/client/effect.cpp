@@ -25,6 +25,12 @@
 #include "game.h"
 #include <framework/core/eventdispatcher.h>
 
+stdext::object_pool<Effect>& Effect::getPool()
+{
+    static stdext::object_pool<Effect> *pool = new stdext::object_pool<Effect>;
+    return *pool;
+}
+
 void Effect::drawEffect(const Point& dest, float scaleFactor, bool animate, int offsetX, int offsetY, LightView *lightView)
 {
     if(m_id == 0)
@@ -32,6 +38,7 @@ void Effect::drawEffect(const Point& dest, float scaleFactor, bool animate, int
 
     int animationPhase = 0;
     if(animate) {
+        g_map.scheduleAnimationFrame(g_clock.millis());
         if(g_game.getFeature(Otc::GameEnhancedAnimations)) {
             // This requires a separate getPhaseAt method as using getPhase would make all magic effects use the same phase regardless of their appearance time
             animationPhase = rawGetThingType()->getAnimator()->getPhaseAt(m_animationTimer.ticksElapsed());
@@ -35,6 +35,10 @@ class Effect : public Thing
     };
 
 public:
+    void *operator new(size_t size) { return getPool().allocate(size); }
+    void operator delete(void *p, size_t size) { getPool().deallocate(p, size); }
+    static stdext::object_pool<Effect>& getPool();
+
     void drawEffect(const Point& dest, float scaleFactor, bool animate, int offsetX = 0, int offsetY = 0, LightView *lightView = nullptr);
 
     void setId(uint32 id);
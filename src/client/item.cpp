@@ -37,11 +37,17 @@
 #include <framework/core/filestream.h>
 #include <framework/core/binarytree.h>
 
+stdext::object_pool<Item>& Item::getPool()
+{
+    static stdext::object_pool<Item> *pool = new stdext::object_pool<Item>;
+    return *pool;
+}
+
 Item::Item() :
     m_clientId(0),
     m_serverId(0),
     m_countOrSubType(1),
-    m_color(Color::alpha),
+    m_data(getEmptyData()),
     m_async(true),
     m_phase(0),
     m_lastPhase(0)
@@ -79,23 +85,51 @@ void Item::draw(const Point& dest, float scaleFactor, bool animate, LightView *l
     int xPattern = 0, yPattern = 0, zPattern = 0;
     calculatePatterns(xPattern, yPattern, zPattern);
 
-    if(m_color != Color::alpha)
-        g_painter->setColor(m_color);
+    if(m_data->color != Color::alpha)
+        g_painter->setColor(m_data->color);
     rawGetThingType()->draw(dest, scaleFactor, 0, xPattern, yPattern, zPattern, animationPhase, lightView);
 
     /// Sanity check
     /// This is just to ensure that we don't overwrite some color and
     /// screw up the whole rendering.
-    if(m_color != Color::alpha)
+    if(m_data->color != Color::alpha)
         g_painter->resetColor();
 }
 
+void Item::prepareDraw(const Point& dest, bool animate, bool lit, const Color& color, float opacity, DrawList& drawList)
+{
+    if(m_clientId == 0)
+        return;
+
+    // this may run in a worker thread, no reference counted pointer can be copied here
+    DrawCommand command;
+    command.thingType = rawGetThingType();
+    command.animator = nullptr;
+    command.animationPhase = 0;
+    if(animate && command.thingType->getAnimationPhases() > 1 && command.thingType->rawGetAnimator())
+        command.animator = command.thingType->rawGetAnimator();
+    else
+        command.animationPhase = calculateAnimationPhase(animate);
+
+    int xPattern = 0, yPattern = 0, zPattern = 0;
+    calculatePatterns(xPattern, yPattern, zPattern);
+    command.xPattern = xPattern;
+    command.yPattern = yPattern;
+    command.zPattern = zPattern;
+
+    command.dest = dest;
+    command.color = m_data->color != Color::alpha ? m_data->color : color;
+    command.opacity = opacity;
+    command.lit = lit;
+    drawList.push_back(command);
+}
+
 void Item::setId(uint32 id)
 {
     if(!g_things.isValidDatId(id, ThingCategoryItem))
         id = 0;
     m_serverId = g_things.findItemTypeByClientId(id)->getServerId();
-    m_clientId = id;
+    updateClientId(id);
 }
 
 void Item::setOtbId(uint16 id)
@@ -108,6 +142,35 @@ void Item::setOtbId(uint16 id)
     id = itemType->getClientId();
     if(!g_things.isValidDatId(id, ThingCategoryItem))
         id = 0;
+    updateClientId(id);
+}
+
+const ItemDataPtr& Item::getEmptyData()
+{
+    static ItemDataPtr *emptyData = new ItemDataPtr(new ItemData);
+    return *emptyData;
+}
+
+ItemData& Item::editData()
+{
+    if(m_data->ref_count() > 1)
+        m_data = ItemDataPtr(new ItemData(*m_data));
+    return *m_data;
+}
+
+void Item::updateClientId(uint16 id)
+{
+    if(m_clientId == id)
+        return;
+
+    // items already on a map tile move to the new id in the map items index
+    if(m_position.isMapPosition()) {
+        const TilePtr& tile = g_map.getTile(m_position);
+        if(tile && tile->hasThing(static_self_cast<Thing>())) {
+            g_map.removeItemFromIndex(m_clientId, m_position);
+            g_map.addItemToIndex(id, m_position);
+        }
+    }
     m_clientId = id;
 }
 
@@ -136,12 +199,12 @@ void Item::unserializeItem(const BinaryTreePtr &in)
                 case ATTR_SCRIPTPROTECTED:
                 case ATTR_DUALWIELD:
                 case ATTR_DECAYING_STATE:
-                    m_attribs.set(attrib, in->getU8());
+                    editData().attribs.set(attrib, in->getU8());
                     break;
                 case ATTR_ACTION_ID:
                 case ATTR_UNIQUE_ID:
                 case ATTR_DEPOT_ID:
-                    m_attribs.set(attrib, in->getU16());
+                    editData().attribs.set(attrib, in->getU16());
                     break;
                 case ATTR_CONTAINER_ITEMS:
                 case ATTR_ATTACK:
@@ -156,14 +219,14 @@ void Item::unserializeItem(const BinaryTreePtr &in)
                 case ATTR_SLEEPERGUID:
                 case ATTR_SLEEPSTART:
                 case ATTR_ATTRIBUTE_MAP:
-                    m_attribs.set(attrib, in->getU32());
+                    editData().attribs.set(attrib, in->getU32());
                     break;
                 case ATTR_TELE_DEST: {
                     Position pos;
                     pos.x = in->getU16();
                     pos.y = in->getU16();
                     pos.z = in->getU8();
-                    m_attribs.set(attrib, pos);
+                    editData().attribs.set(attrib, pos);
                     break;
                 }
                 case ATTR_NAME:
@@ -171,7 +234,7 @@ void Item::unserializeItem(const BinaryTreePtr &in)
                 case ATTR_DESC:
                 case ATTR_ARTICLE:
                 case ATTR_WRITTENBY:
-                    m_attribs.set(attrib, in->getString());
+                    editData().attribs.set(attrib, in->getString());
                     break;
                 default:
                     stdext::throw_exception(stdext::format("invalid item attribute %d", attrib));
@@ -193,7 +256,7 @@ void Item::serializeItem(const OutputBinaryTreePtr& out)
     out->addU8(ATTR_CHARGES);
     out->addU16(getCountOrSubType());
 
-    Position dest = m_attribs.get<Position>(ATTR_TELE_DEST);
+    Position dest = m_data->attribs.get<Position>(ATTR_TELE_DEST);
     if(dest.isValid()) {
         out->addU8(ATTR_TELE_DEST);
         out->addPos(dest.x, dest.y, dest.z);
@@ -209,8 +272,8 @@ void Item::serializeItem(const OutputBinaryTreePtr& out)
         out->addU8(getDoorId());
     }
 
-    uint16 aid = m_attribs.get<uint16>(ATTR_ACTION_ID);
-    uint16 uid = m_attribs.get<uint16>(ATTR_UNIQUE_ID);
+    uint16 aid = m_data->attribs.get<uint16>(ATTR_ACTION_ID);
+    uint16 uid = m_data->attribs.get<uint16>(ATTR_UNIQUE_ID);
     if(aid) {
         out->addU8(ATTR_ACTION_ID);
         out->addU16(aid);
@@ -233,7 +296,7 @@ void Item::serializeItem(const OutputBinaryTreePtr& out)
     }
 
     out->endNode();
-    for(auto i : m_containerItems)
+    for(auto i : m_data->containerItems)
         i->serializeItem(out);
 }
 
@@ -382,16 +445,22 @@ int Item::calculateAnimationPhase(bool animate)
 {
     if(getAnimationPhases() > 1) {
         if(animate) {
-            if(getAnimator() != nullptr)
-                return getAnimator()->getPhase();
+            if(getAnimator() != nullptr) {
+                int phase = getAnimator()->getPhase();
+                g_map.scheduleAnimationFrame(getAnimator()->getNextPhaseTime());
+                return phase;
+            }
 
-            if(m_async)
-                return (g_clock.millis() % (Otc::ITEM_TICKS_PER_FRAME * getAnimationPhases())) / Otc::ITEM_TICKS_PER_FRAME;
-            else {
-                if(g_clock.millis() - m_lastPhase >= Otc::ITEM_TICKS_PER_FRAME) {
+            ticks_t ticks = g_clock.millis();
+            if(m_async) {
+                g_map.scheduleAnimationFrame(ticks - ticks % Otc::ITEM_TICKS_PER_FRAME + Otc::ITEM_TICKS_PER_FRAME);
+                return (ticks % (Otc::ITEM_TICKS_PER_FRAME * getAnimationPhases())) / Otc::ITEM_TICKS_PER_FRAME;
+            } else {
+                if(ticks - m_lastPhase >= Otc::ITEM_TICKS_PER_FRAME) {
                     m_phase = (m_phase + 1) % getAnimationPhases();
-                    m_lastPhase = g_clock.millis();
+                    m_lastPhase = ticks;
                 }
+                g_map.scheduleAnimationFrame(m_lastPhase + Otc::ITEM_TICKS_PER_FRAME);
                 return m_phase;
             }
         } else
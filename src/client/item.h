@@ -28,6 +28,7 @@
 #include "thing.h"
 #include "effect.h"
 #include "itemtype.h"
+#include "drawlist.h"
 
 enum ItemAttr : uint8
 {
@@ -71,6 +72,20 @@ enum ItemAttr : uint8
     ATTR_ATTRIBUTE_MAP = 128
 };
 
+// item state that most map items don't have, plain items share one empty instance
+// and get their own copy the first time any of it changes
+class ItemData : public stdext::shared_object
+{
+public:
+    ItemData() : color(Color::alpha) { }
+    ItemData(const ItemData& other) : stdext::shared_object(), attribs(other.attribs), containerItems(other.containerItems), color(other.color) { }
+
+    stdext::packed_storage<uint8> attribs;
+    ItemVector containerItems;
+    Color color;
+};
+typedef stdext::shared_object_ptr<ItemData> ItemDataPtr;
+
 // @bindclass
 #pragma pack(push,1) // disable memory alignment
 class Item : public Thing
@@ -79,17 +94,22 @@ public:
     Item();
     virtual ~Item() { }
 
+    void *operator new(size_t size) { return getPool().allocate(size); }
+    void operator delete(void *p, size_t size) { getPool().deallocate(p, size); }
+    static stdext::object_pool<Item>& getPool();
+
     static ItemPtr create(int id);
     static ItemPtr createFromOtb(int id);
 
     void draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView = nullptr);
+    void prepareDraw(const Point& dest, bool animate, bool lit, const Color& color, float opacity, DrawList& drawList);
 
     void setId(uint32 id);
     void setOtbId(uint16 id);
     void setCountOrSubType(int value) { m_countOrSubType = value; }
     void setCount(int count) { m_countOrSubType = count; }
     void setSubType(int subType) { m_countOrSubType = subType; }
-    void setColor(const Color& c) { m_color = c; }
+    void setColor(const Color& c) { editData().color = c; }
 
     int getCountOrSubType() { return m_countOrSubType; }
     int getSubType();
@@ -103,32 +123,32 @@ public:
     void unserializeItem(const BinaryTreePtr& in);
     void serializeItem(const OutputBinaryTreePtr& out);
 
-    void setDepotId(uint16 depotId) { m_attribs.set(ATTR_DEPOT_ID, depotId); }
-    uint16 getDepotId() { return m_attribs.get<uint16>(ATTR_DEPOT_ID); }
+    void setDepotId(uint16 depotId) { editData().attribs.set(ATTR_DEPOT_ID, depotId); }
+    uint16 getDepotId() { return m_data->attribs.get<uint16>(ATTR_DEPOT_ID); }
 
-    void setDoorId(uint8 doorId) { m_attribs.set(ATTR_HOUSEDOORID, doorId); }
-    uint8 getDoorId() { return m_attribs.get<uint8>(ATTR_HOUSEDOORID); }
+    void setDoorId(uint8 doorId) { editData().attribs.set(ATTR_HOUSEDOORID, doorId); }
+    uint8 getDoorId() { return m_data->attribs.get<uint8>(ATTR_HOUSEDOORID); }
 
-    uint16 getUniqueId() { return m_attribs.get<uint16>(ATTR_ACTION_ID); }
-    uint16 getActionId() { return m_attribs.get<uint16>(ATTR_UNIQUE_ID); }
-    void setActionId(uint16 actionId) { m_attribs.set(ATTR_ACTION_ID, actionId); }
-    void setUniqueId(uint16 uniqueId) { m_attribs.set(ATTR_UNIQUE_ID, uniqueId); }
+    uint16 getUniqueId() { return m_data->attribs.get<uint16>(ATTR_ACTION_ID); }
+    uint16 getActionId() { return m_data->attribs.get<uint16>(ATTR_UNIQUE_ID); }
+    void setActionId(uint16 actionId) { editData().attribs.set(ATTR_ACTION_ID, actionId); }
+    void setUniqueId(uint16 uniqueId) { editData().attribs.set(ATTR_UNIQUE_ID, uniqueId); }
 
-    std::string getText() { return m_attribs.get<std::string>(ATTR_TEXT); }
-    std::string getDescription() { return m_attribs.get<std::string>(ATTR_DESC); }
-    void setDescription(std::string desc) { m_attribs.set(ATTR_DESC, desc); }
-    void setText(std::string txt) { m_attribs.set(ATTR_TEXT, txt); }
+    std::string getText() { return m_data->attribs.get<std::string>(ATTR_TEXT); }
+    std::string getDescription() { return m_data->attribs.get<std::string>(ATTR_DESC); }
+    void setDescription(std::string desc) { editData().attribs.set(ATTR_DESC, desc); }
+    void setText(std::string txt) { editData().attribs.set(ATTR_TEXT, txt); }
 
-    Position getTeleportDestination() { return m_attribs.get<Position>(ATTR_TELE_DEST); }
-    void setTeleportDestination(const Position& pos) { m_attribs.set(ATTR_TELE_DEST, pos); }
+    Position getTeleportDestination() { return m_data->attribs.get<Position>(ATTR_TELE_DEST); }
+    void setTeleportDestination(const Position& pos) { editData().attribs.set(ATTR_TELE_DEST, pos); }
 
     void setAsync(bool enable) { m_async = enable; }
 
-    bool isHouseDoor() { return m_attribs.has(ATTR_HOUSEDOORID); }
-    bool isDepot() { return m_attribs.has(ATTR_DEPOT_ID); }
-    bool isContainer() { return m_attribs.has(ATTR_CONTAINER_ITEMS); }
-    bool isDoor() { return m_attribs.has(ATTR_HOUSEDOORID); }
-    bool isTeleport() { return m_attribs.has(ATTR_TELE_DEST); }
+    bool isHouseDoor() { return m_data->attribs.has(ATTR_HOUSEDOORID); }
+    bool isDepot() { return m_data->attribs.has(ATTR_DEPOT_ID); }
+    bool isContainer() { return m_data->attribs.has(ATTR_CONTAINER_ITEMS); }
+    bool isDoor() { return m_data->attribs.has(ATTR_HOUSEDOORID); }
+    bool isTeleport() { return m_data->attribs.has(ATTR_TELE_DEST); }
     bool isMoveable();
     bool isGround();
 
@@ -136,12 +156,12 @@ public:
     ItemPtr asItem() { return static_self_cast<Item>(); }
     bool isItem() { return true; }
 
-    ItemVector getContainerItems() { return m_containerItems; }
-    ItemPtr getContainerItem(int slot) { return m_containerItems[slot]; }
-    void addContainerItemIndexed(const ItemPtr& i, int slot) { m_containerItems[slot] = i; }
-    void addContainerItem(const ItemPtr& i) { m_containerItems.push_back(i); }
-    void removeContainerItem(int slot) { m_containerItems[slot] = nullptr; }
-    void clearContainerItems() { m_containerItems.clear(); }
+    ItemVector getContainerItems() { return m_data->containerItems; }
+    ItemPtr getContainerItem(int slot) { return m_data->containerItems[slot]; }
+    void addContainerItemIndexed(const ItemPtr& i, int slot) { editData().containerItems[slot] = i; }
+    void addContainerItem(const ItemPtr& i) { editData().containerItems.push_back(i); }
+    void removeContainerItem(int slot) { editData().containerItems[slot] = nullptr; }
+    void clearContainerItems() { editData().containerItems.clear(); }
 
     void calculatePatterns(int& xPattern, int& yPattern, int& zPattern);
     int calculateAnimationPhase(bool animate);
@@ -151,12 +171,14 @@ public:
     ThingType *rawGetThingType();
 
 private:
+    void updateClientId(uint16 id);
+    ItemData& editData();
+    static const ItemDataPtr& getEmptyData();
+
     uint16 m_clientId;
     uint16 m_serverId;
     uint8 m_countOrSubType;
-    stdext::packed_storage<uint8> m_attribs;
-    ItemVector m_containerItems;
-    Color m_color;
+    ItemDataPtr m_data;
     bool m_async;
 
     uint8 m_phase;
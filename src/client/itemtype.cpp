@@ -91,3 +91,31 @@ void ItemType::unserialize(const BinaryTreePtr& node)
         }
     }
 }
+
+void ItemType::serializeSnapshot(const FileStreamPtr& fin)
+{
+    fin->addU8(m_null ? 1 : 0);
+    fin->addU8(m_category);
+    fin->addU16(getServerId());
+    fin->addU16(getClientId());
+    fin->addString(getName());
+    fin->addString(getDesc());
+    fin->addU8(isWritable() ? 1 : 0);
+}
+
+void ItemType::unserializeSnapshot(const FileStreamPtr& fin)
+{
+    m_null = fin->getU8() != 0;
+    m_category = (ItemCategory)fin->getU8();
+    setServerId(fin->getU16());
+    setClientId(fin->getU16());
+
+    std::string name = fin->getString();
+    if(!name.empty())
+        setName(name);
+    std::string desc = fin->getString();
+    if(!desc.empty())
+        setDesc(desc);
+    if(fin->getU8())
+        m_attribs.set(ItemTypeAttrWritable, true);
+}
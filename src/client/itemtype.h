@@ -133,6 +133,8 @@ public:
     ItemType();
 
     void unserialize(const BinaryTreePtr& node);
+    void serializeSnapshot(const FileStreamPtr& fin);
+    void unserializeSnapshot(const FileStreamPtr& fin);
 
     void setServerId(uint16 serverId) { m_attribs.set(ItemTypeAttrServerId, serverId); }
     uint16 getServerId() { return m_attribs.get<uint16>(ItemTypeAttrServerId); }
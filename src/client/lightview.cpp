@@ -26,17 +26,27 @@
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/graphics/painter.h>
 #include <framework/graphics/image.h>
+#include <framework/core/profiler.h>
 
 enum {
     MAX_LIGHT_INTENSITY = 8,
-    MAX_AMBIENT_LIGHT_INTENSITY = 255
+    MAX_AMBIENT_LIGHT_INTENSITY = 255,
+    // the light map is smooth enough to be drawn at a lower resolution and upscaled bilinearly
+    LIGHT_MAP_DOWNSCALE = 2
 };
 
+static void hashCombine(size_t& seed, size_t value)
+{
+    seed ^= value + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
 LightView::LightView()
 {
     m_lightbuffer = g_framebuffers.createFrameBuffer();
+    m_staticLightbuffer = g_framebuffers.createFrameBuffer();
     m_lightTexture = generateLightBubble(0.1f);
     m_blendEquation = Painter::BlendEquation_Add;
+    m_bakedLightsHash = 0;
     reset();
 }
 
@@ -68,15 +78,19 @@ TexturePtr LightView::generateLightBubble(float centerFactor)
 
 void LightView::reset()
 {
-    m_lightMap.clear();
+    m_staticLights.clear();
+    m_dynamicLights.clear();
+    m_staticLightsHash = 0;
 }
 
 void LightView::setGlobalLight(const Light& light)
 {
+    if(m_globalLight.intensity != light.intensity || m_globalLight.color != light.color)
+        m_staticLightsBaked = false;
     m_globalLight = light;
 }
 
-void LightView::addLightSource(const Point& center, float scaleFactor, const Light& light)
+void LightView::addLightSource(const Point& center, float scaleFactor, const Light& light, bool dynamic)
 {
     int intensity = std::min<int>(light.intensity, MAX_LIGHT_INTENSITY);
     int radius = intensity * Otc::TILE_PIXELS * scaleFactor;
@@ -88,8 +102,9 @@ void LightView::addLightSource(const Point& center, float scaleFactor, const Lig
     color.setGreen(color.gF() * brightness);
     color.setBlue(color.bF() * brightness);
 
-    if(m_blendEquation == Painter::BlendEquation_Add && !m_lightMap.empty()) {
-        LightSource prevSource = m_lightMap.back();
+    std::vector<LightSource>& lights = dynamic ? m_dynamicLights : m_staticLights;
+    if(m_blendEquation == Painter::BlendEquation_Add && !lights.empty()) {
+        const LightSource& prevSource = lights.back();
         if(prevSource.center == center && prevSource.color == color && prevSource.radius == radius)
             return;
     }
@@ -98,10 +113,18 @@ void LightView::addLightSource(const Point& center, float scaleFactor, const Lig
     source.center = center;
     source.color = color;
     source.radius = radius;
-    m_lightMap.push_back(source);
+    lights.push_back(source);
+
+    // static lights are baked once and only drawn again when this hash changes
+    if(!dynamic) {
+        hashCombine(m_staticLightsHash, center.x);
+        hashCombine(m_staticLightsHash, center.y);
+        hashCombine(m_staticLightsHash, radius);
+        hashCombine(m_staticLightsHash, color.rgba());
+    }
 }
 
-void LightView::drawGlobalLight(const Light& light)
+void LightView::drawGlobalLight(const Light& light, const Size& size)
 {
     Color color = Color::from8bit(light.color);
     float brightness = light.intensity / (float)MAX_AMBIENT_LIGHT_INTENSITY;
@@ -109,7 +132,7 @@ void LightView::drawGlobalLight(const Light& light)
     color.setGreen(color.gF() * brightness);
     color.setBlue(color.bF() * brightness);
     g_painter->setColor(color);
-    g_painter->drawFilledRect(Rect(0,0,m_lightbuffer->getSize()));
+    g_painter->drawFilledRect(Rect(0,0,size));
 }
 
 void LightView::drawLightSource(const Point& center, const Color& color, int radius)
@@ -117,28 +140,65 @@ void LightView::drawLightSource(const Point& center, const Color& color, int rad
     // debug draw
     //radius /= 16;
 
-    Rect dest = Rect(center - Point(radius, radius), Size(radius*2,radius*2));
+    Point downscaledCenter = center / LIGHT_MAP_DOWNSCALE;
+    radius /= LIGHT_MAP_DOWNSCALE;
+    Rect dest = Rect(downscaledCenter - Point(radius, radius), Size(radius*2,radius*2));
     g_painter->setColor(color);
     g_painter->drawTexturedRect(dest, m_lightTexture);
 }
 
 void LightView::resize(const Size& size)
 {
-    m_lightbuffer->resize(size);
+    Size lightMapSize((size.width() + LIGHT_MAP_DOWNSCALE - 1) / LIGHT_MAP_DOWNSCALE,
+                      (size.height() + LIGHT_MAP_DOWNSCALE - 1) / LIGHT_MAP_DOWNSCALE);
+    if(m_lightbuffer->getSize() == lightMapSize)
+        return;
+
+    m_lightbuffer->resize(lightMapSize);
+    m_staticLightbuffer->resize(lightMapSize);
+    m_staticLightsBaked = false;
 }
 
-void LightView::draw(const Rect& dest, const Rect& src)
+void LightView::bakeStaticLights()
 {
-    g_painter->saveAndResetState();
-    m_lightbuffer->bind();
+    m_staticLightbuffer->bind();
     g_painter->setCompositionMode(Painter::CompositionMode_Replace);
-    drawGlobalLight(m_globalLight);
+    drawGlobalLight(m_globalLight, m_staticLightbuffer->getSize());
     g_painter->setBlendEquation(m_blendEquation);
     g_painter->setCompositionMode(Painter::CompositionMode_Add);
-    for(const LightSource& source : m_lightMap)
+    for(const LightSource& source : m_staticLights)
         drawLightSource(source.center, source.color, source.radius);
-    m_lightbuffer->release();
+    m_staticLightbuffer->release();
+
+    m_bakedLightsHash = m_staticLightsHash;
+    m_staticLightsBaked = true;
+}
+
+void LightView::draw(const Rect& dest, const Rect& src)
+{
+    ProfilerZone zone("light");
+    g_painter->saveAndResetState();
+
+    if(!m_staticLightsBaked || m_bakedLightsHash != m_staticLightsHash)
+        bakeStaticLights();
+
+    // dynamic lights (creatures, effects and missiles) are added on top of a copy of the baked lights
+    FrameBufferPtr lightbuffer = m_staticLightbuffer;
+    if(!m_dynamicLights.empty()) {
+        lightbuffer = m_lightbuffer;
+        lightbuffer->bind();
+        g_painter->setBlendEquation(Painter::BlendEquation_Add);
+        g_painter->setCompositionMode(Painter::CompositionMode_Replace);
+        m_staticLightbuffer->draw(Rect(0, 0, lightbuffer->getSize()));
+        g_painter->setBlendEquation(m_blendEquation);
+        g_painter->setCompositionMode(Painter::CompositionMode_Add);
+        for(const LightSource& source : m_dynamicLights)
+            drawLightSource(source.center, source.color, source.radius);
+        lightbuffer->release();
+    }
+
+    g_painter->setBlendEquation(m_blendEquation);
     g_painter->setCompositionMode(Painter::CompositionMode_Light);
-    m_lightbuffer->draw(dest, src);
+    lightbuffer->draw(dest, Rect(src.topLeft() / LIGHT_MAP_DOWNSCALE, src.size() / LIGHT_MAP_DOWNSCALE));
     g_painter->restoreSavedState();
 }
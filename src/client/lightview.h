@@ -41,22 +41,28 @@ public:
 
     void reset();
     void setGlobalLight(const Light& light);
-    void addLightSource(const Point& center, float scaleFactor, const Light& light);
+    void addLightSource(const Point& center, float scaleFactor, const Light& light, bool dynamic = false);
     void resize(const Size& size);
     void draw(const Rect& dest, const Rect& src);
 
-    void setBlendEquation(Painter::BlendEquation blendEquation) { m_blendEquation = blendEquation; }
+    void setBlendEquation(Painter::BlendEquation blendEquation) { m_blendEquation = blendEquation; m_staticLightsBaked = false; }
 
 private:
-    void drawGlobalLight(const Light& light);
+    void drawGlobalLight(const Light& light, const Size& size);
     void drawLightSource(const Point& center, const Color& color, int radius);
+    void bakeStaticLights();
     TexturePtr generateLightBubble(float centerFactor);
 
     Painter::BlendEquation m_blendEquation;
     TexturePtr m_lightTexture;
     FrameBufferPtr m_lightbuffer;
+    FrameBufferPtr m_staticLightbuffer;
     Light m_globalLight;
-    std::vector<LightSource> m_lightMap;
+    std::vector<LightSource> m_staticLights;
+    std::vector<LightSource> m_dynamicLights;
+    size_t m_staticLightsHash;
+    size_t m_bakedLightsHash;
+    stdext::boolean<false> m_staticLightsBaked;
 };
 
 #endif
@@ -37,6 +37,8 @@
 #include "localplayer.h"
 #include "map.h"
 #include "minimap.h"
+#include "outfitcache.h"
+#include "creatureanimator.h"
 #include "thingtypemanager.h"
 #include "spritemanager.h"
 #include "shadermanager.h"
@@ -71,8 +73,37 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_things", "findItemTypeByName", &ThingTypeManager::findItemTypeByName, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypesByName", &ThingTypeManager::findItemTypesByName, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypesByString", &ThingTypeManager::findItemTypesByString, &g_things);
+    g_lua.bindSingletonFunction("g_things", "searchItemTypes", &ThingTypeManager::searchItemTypes, &g_things);
     g_lua.bindSingletonFunction("g_things", "findItemTypeByCategory", &ThingTypeManager::findItemTypeByCategory, &g_things);
     g_lua.bindSingletonFunction("g_things", "findThingTypeByAttr", &ThingTypeManager::findThingTypeByAttr, &g_things);
+    g_lua.bindSingletonFunction("g_things", "setTextureMemoryBudget", &ThingTypeManager::setTextureMemoryBudget, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getTextureMemoryBudget", &ThingTypeManager::getTextureMemoryBudget, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getTextureMemoryUsage", &ThingTypeManager::getTextureMemoryUsage, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getTextureMemoryPeak", &ThingTypeManager::getTextureMemoryPeak, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getLoadedTextures", &ThingTypeManager::getLoadedTextures, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getReleasedTextures", &ThingTypeManager::getReleasedTextures, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getPendingTextures", &ThingTypeManager::getPendingTextures, &g_things);
+    g_lua.bindSingletonFunction("g_things", "setSnapshotsEnabled", &ThingTypeManager::setSnapshotsEnabled, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isSnapshotsEnabled", &ThingTypeManager::isSnapshotsEnabled, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getDatLoadTime", &ThingTypeManager::getDatLoadTime, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getOtbLoadTime", &ThingTypeManager::getOtbLoadTime, &g_things);
+    g_lua.bindSingletonFunction("g_things", "getXmlLoadTime", &ThingTypeManager::getXmlLoadTime, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isDatFromSnapshot", &ThingTypeManager::isDatFromSnapshot, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isOtbFromSnapshot", &ThingTypeManager::isOtbFromSnapshot, &g_things);
+    g_lua.bindSingletonFunction("g_things", "isXmlFromSnapshot", &ThingTypeManager::isXmlFromSnapshot, &g_things);
+
+    g_lua.registerSingletonClass("g_outfitCache");
+    g_lua.bindSingletonFunction("g_outfitCache", "clear",           &OutfitCache::clear,           &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "setEnabled",      &OutfitCache::setEnabled,      &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "setCacheSize",    &OutfitCache::setCacheSize,    &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "isEnabled",       &OutfitCache::isEnabled,       &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "getCacheSize",    &OutfitCache::getCacheSize,    &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "getCachedFrames", &OutfitCache::getCachedFrames, &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "getHits",         &OutfitCache::getHits,         &g_outfitCache);
+    g_lua.bindSingletonFunction("g_outfitCache", "getMisses",       &OutfitCache::getMisses,       &g_outfitCache);
+
+    g_lua.registerSingletonClass("g_creatureAnimator");
+    g_lua.bindSingletonFunction("g_creatureAnimator", "getAnimatedCreatures", &CreatureAnimator::getAnimatedCreatures, &g_creatureAnimator);
 
     g_lua.registerSingletonClass("g_houses");
     g_lua.bindSingletonFunction("g_houses", "clear",          &HouseManager::clear,          &g_houses);
@@ -153,6 +184,8 @@ void Client::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_map", "beginGhostMode", &Map::beginGhostMode, &g_map);
     g_lua.bindSingletonFunction("g_map", "endGhostMode", &Map::endGhostMode, &g_map);
     g_lua.bindSingletonFunction("g_map", "findItemsById", &Map::findItemsById, &g_map);
+    g_lua.bindSingletonFunction("g_map", "findItemsByIdInRange", &Map::findItemsByIdInRange, &g_map);
+    g_lua.bindSingletonFunction("g_map", "getObjectPoolStats", &Map::getObjectPoolStats, &g_map);
 
     g_lua.registerSingletonClass("g_minimap");
     g_lua.bindSingletonFunction("g_minimap", "clean", &Minimap::clean, &g_minimap);
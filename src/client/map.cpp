@@ -25,6 +25,7 @@
 #include "localplayer.h"
 #include "tile.h"
 #include "item.h"
+#include "effect.h"
 #include "missile.h"
 #include "statictext.h"
 #include "mapview.h"
@@ -39,6 +40,7 @@ TilePtr Map::m_nulltile;
 void Map::init()
 {
     resetAwareRange();
+    resetAnimationFrame();
     m_animationFlags |= Animation_Show;
 }
 
@@ -75,6 +77,7 @@ void Map::clean()
 
     for(int i=0;i<=Otc::MAX_Z;++i)
         m_tileBlocks[i].clear();
+    m_itemsIndex.clear();
 
     m_waypoints.clear();
 
@@ -109,6 +112,9 @@ void Map::addThing(const ThingPtr& thing, const Position& pos, int stackPos)
     if(!thing)
         return;
 
+    // start decoding its sprites now, so the texture is likely uploaded by the time it's drawn
+    thing->rawGetThingType()->prefetchTextures();
+
     if(thing->isItem() || thing->isCreature() || thing->isEffect()) {
         const TilePtr& tile = getOrCreateTile(pos);
         if(tile)
@@ -156,8 +162,10 @@ void Map::addThing(const ThingPtr& thing, const Position& pos, int stackPos)
 
             if(mustAdd)
                 m_staticTexts.push_back(staticText);
-            else
+            else {
+                g_app.repaintBackground();
                 return;
+            }
         }
 
         thing->setPosition(pos);
@@ -221,6 +229,7 @@ void Map::colorizeThing(const ThingPtr& thing, const Color& color)
     if(!thing)
         return;
 
+    g_app.repaintBackground();
     if(thing->isItem())
         thing->static_self_cast<Item>()->setColor(color);
     else if(thing->isCreature()) {
@@ -239,6 +248,7 @@ void Map::removeThingColor(const ThingPtr& thing)
     if(!thing)
         return;
 
+    g_app.repaintBackground();
     if(thing->isItem())
         thing->static_self_cast<Item>()->setColor(Color::alpha);
     else if(thing->isCreature()) {
@@ -252,6 +262,12 @@ void Map::removeThingColor(const ThingPtr& thing)
     }
 }
 
+void Map::setLight(const Light& light)
+{
+    m_light = light;
+    g_app.repaintBackground();
+}
+
 StaticTextPtr Map::getStaticText(const Position& pos)
 {
     for(auto staticText : m_staticTexts) {
@@ -439,23 +455,39 @@ void Map::endGhostMode()
     g_painter->resetOpacity();
 }
 
+static uint64 packPosition(const Position& pos)
+{
+    // sorted by floor, then row, then column
+    return (uint64)pos.z << 32 | (uint64)pos.y << 16 | (uint64)pos.x;
+}
+
 std::map<Position, ItemPtr> Map::findItemsById(uint16 clientId, uint32 max)
+{
+    return findItemsByIdInRange(clientId, Position(0, 0, 0), Position(65535, 65535, Otc::MAX_Z), max);
+}
+
+std::map<Position, ItemPtr> Map::findItemsByIdInRange(uint16 clientId, const Position& from, const Position& to, uint32 max)
 {
     std::map<Position, ItemPtr> ret;
+    auto it = m_itemsIndex.find(clientId);
+    if(it == m_itemsIndex.end())
+        return ret;
+
     uint32 count = 0;
-    for(uint8_t z = 0; z <= Otc::MAX_Z; ++z) {
-        for(const auto& pair : m_tileBlocks[z]) {
-            const TileBlock& block = pair.second;
-            for(const TilePtr& tile : block.getTiles()) {
-                if(unlikely(!tile || tile->isEmpty()))
-                    continue;
-                for(const ItemPtr& item : tile->getItems()) {
-                    if(item->getId() == clientId) {
-                        ret.insert(std::make_pair(tile->getPosition(), item));
-                        if(++count >= max)
-                            break;
-                    }
-                }
+    for(const auto& pair : it->second) {
+        Position pos(pair.first & 0xFFFF, (pair.first >> 16) & 0xFFFF, pair.first >> 32);
+        if(pos.x < from.x || pos.x > to.x || pos.y < from.y || pos.y > to.y || pos.z < from.z || pos.z > to.z)
+            continue;
+
+        const TilePtr& tile = getTile(pos);
+        if(!tile)
+            continue;
+
+        for(const ThingPtr& thing : tile->getThings()) {
+            if(thing->isItem() && thing->getId() == clientId) {
+                ret.insert(std::make_pair(pos, thing->static_self_cast<Item>()));
+                if(++count >= max)
+                    return ret;
             }
         }
     }
@@ -463,6 +495,51 @@ std::map<Position, ItemPtr> Map::findItemsById(uint16 clientId, uint32 max)
     return ret;
 }
 
+void Map::addItemToIndex(uint16 clientId, const Position& pos)
+{
+    m_itemsIndex[clientId][packPosition(pos)]++;
+}
+
+void Map::removeItemFromIndex(uint16 clientId, const Position& pos)
+{
+    auto it = m_itemsIndex.find(clientId);
+    if(it == m_itemsIndex.end())
+        return;
+
+    auto posIt = it->second.find(packPosition(pos));
+    if(posIt == it->second.end())
+        return;
+
+    if(--posIt->second == 0) {
+        it->second.erase(posIt);
+        if(it->second.empty())
+            m_itemsIndex.erase(it);
+    }
+}
+
+template<typename T>
+static std::map<std::string, int> getPoolStats(const stdext::object_pool<T>& pool)
+{
+    std::map<std::string, int> stats;
+    stats["used"] = pool.used();
+    stats["capacity"] = pool.capacity();
+    stats["slabs"] = pool.slabs();
+    stats["peak"] = pool.peak();
+    stats["allocations"] = pool.allocations();
+    stats["fallbacks"] = pool.fallbacks();
+    return stats;
+}
+
+std::map<std::string, std::map<std::string, int>> Map::getObjectPoolStats()
+{
+    std::map<std::string, std::map<std::string, int>> stats;
+    stats["items"] = getPoolStats(Item::getPool());
+    stats["tiles"] = getPoolStats(Tile::getPool());
+    stats["effects"] = getPoolStats(Effect::getPool());
+    stats["missiles"] = getPoolStats(Missile::getPool());
+    return stats;
+}
+
 void Map::addCreature(const CreaturePtr& creature)
 {
     m_knownCreatures[creature->getId()] = creature;
@@ -516,9 +593,13 @@ void Map::removeUnawareThings()
                         continue;
 
                     const Position& pos = tile->getPosition();
-                    if(!isAwareOfPosition(pos))
+                    if(!isAwareOfPosition(pos)) {
+                        for(const ThingPtr& thing : tile->getThings()) {
+                            if(thing->isItem())
+                                removeItemFromIndex(thing->getId(), pos);
+                        }
                         block.remove(pos);
-                    else
+                    } else
                         blockEmpty = false;
                 }
 
@@ -623,7 +704,7 @@ bool Map::isCovered(const Position& pos, int firstFloor)
     // check for tiles on top of the postion
     Position tilePos = pos;
     while(tilePos.coveredUp() && tilePos.z >= firstFloor) {
-        TilePtr tile = getTile(tilePos);
+        const TilePtr& tile = getTile(tilePos);
         // the below tile is covered when the above tile has a full ground
         if(tile && tile->isFullGround())
             return true;
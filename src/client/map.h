@@ -206,10 +206,23 @@ public:
     bool isShowingAnimations();
     void setShowAnimations(bool show);
 
+    // drawn animations report when their phase changes next, map views damage the frame at that time
+    void scheduleAnimationFrame(ticks_t time) { m_nextAnimationFrame = std::min<ticks_t>(m_nextAnimationFrame, time); }
+    void resetAnimationFrame() { m_nextAnimationFrame = std::numeric_limits<ticks_t>::max(); }
+    ticks_t getNextAnimationFrame() { return m_nextAnimationFrame; }
+
     void beginGhostMode(float opacity);
     void endGhostMode();
 
     std::map<Position, ItemPtr> findItemsById(uint16 clientId, uint32 max);
+    std::map<Position, ItemPtr> findItemsByIdInRange(uint16 clientId, const Position& from, const Position& to, uint32 max);
+
+    // kept by the tiles, every item added to or removed from a tile updates its client id entry
+    void addItemToIndex(uint16 clientId, const Position& pos);
+    void removeItemFromIndex(uint16 clientId, const Position& pos);
+
+    // usage of the item, tile, effect and missile pools
+    std::map<std::string, std::map<std::string, int>> getObjectPoolStats();
 
     // known creature related
     void addCreature(const CreaturePtr& creature);
@@ -220,7 +233,7 @@ public:
     std::vector<CreaturePtr> getSpectatorsInRange(const Position& centerPos, bool multiFloor, int xRange, int yRange);
     std::vector<CreaturePtr> getSpectatorsInRangeEx(const Position& centerPos, bool multiFloor, int minXRange, int maxXRange, int minYRange, int maxYRange);
 
-    void setLight(const Light& light) { m_light = light; }
+    void setLight(const Light& light);
     void setCentralPosition(const Position& centralPosition);
 
     bool isLookPossible(const Position& pos);
@@ -249,6 +262,7 @@ private:
 
     std::unordered_map<uint, TileBlock> m_tileBlocks[Otc::MAX_Z+1];
     std::unordered_map<uint32, CreaturePtr> m_knownCreatures;
+    std::unordered_map<uint16, std::map<uint64, int>> m_itemsIndex; // client id => packed positions => item count
     std::array<std::vector<MissilePtr>, Otc::MAX_Z+1> m_floorMissiles;
     std::vector<AnimatedTextPtr> m_animatedTexts;
     std::vector<StaticTextPtr> m_staticTexts;
@@ -256,6 +270,7 @@ private:
     std::unordered_map<Position, std::string, Position::Hasher> m_waypoints;
 
     uint8 m_animationFlags;
+    ticks_t m_nextAnimationFrame;
     uint32 m_zoneFlags;
     std::map<uint32, Color> m_zoneColors;
     float m_zoneOpacity;
@@ -30,13 +30,17 @@
 #include "missile.h"
 #include "shadermanager.h"
 #include "lightview.h"
+#include "animator.h"
+#include "thingtype.h"
 
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/image.h>
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/asyncdispatcher.h>
 #include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 
 
 enum {
@@ -77,6 +81,11 @@ MapView::~MapView()
 
 void MapView::draw(const Rect& rect)
 {
+    ProfilerZone zone("map");
+
+    // textures prefetched for things that are not drawn yet must be uploaded too
+    g_things.uploadTextures();
+
     // update visible tiles cache when needed
     if(m_mustUpdateVisibleTilesCache || m_updateTilesPos > 0)
         updateVisibleTilesCache(m_mustUpdateVisibleTilesCache ? 0 : m_updateTilesPos);
@@ -127,27 +136,35 @@ void MapView::draw(const Rect& rect)
         }
         g_painter->setColor(Color::white);
 
-        auto it = m_cachedVisibleTiles.begin();
-        auto end = m_cachedVisibleTiles.end();
-        for(int z=m_cachedLastVisibleFloor;z>=m_cachedFirstVisibleFloor;--z) {
+        g_map.resetAnimationFrame();
 
-            while(it != end) {
-                const TilePtr& tile = *it;
-                Position tilePos = tile->getPosition();
-                if(tilePos.z != z)
-                    break;
-                else
-                    ++it;
+        // far and huge views only draw items, their floors are prepared in parallel unless animations are forced,
+        // animated items update their phase and report their next frame while being prepared
+        if((m_viewMode == FAR_VIEW || m_viewMode == HUGE_VIEW) && !(drawFlags & Otc::DrawAnimations)) {
+            drawFloorsInParallel(cameraPosition, scaleFactor, drawFlags);
+        } else {
+            auto it = m_cachedVisibleTiles.begin();
+            auto end = m_cachedVisibleTiles.end();
+            for(int z=m_cachedLastVisibleFloor;z>=m_cachedFirstVisibleFloor;--z) {
+
+                while(it != end) {
+                    const TilePtr& tile = *it;
+                    Position tilePos = tile->getPosition();
+                    if(tilePos.z != z)
+                        break;
+                    else
+                        ++it;
 
-                if (g_map.isCovered(tilePos, m_cachedFirstVisibleFloor))
-                    tile->draw(transformPositionTo2D(tilePos, cameraPosition), scaleFactor, drawFlags);
-                else
-                    tile->draw(transformPositionTo2D(tilePos, cameraPosition), scaleFactor, drawFlags, m_lightView.get());
-            }
+                    if (g_map.isCovered(tilePos, m_cachedFirstVisibleFloor))
+                        tile->draw(transformPositionTo2D(tilePos, cameraPosition), scaleFactor, drawFlags);
+                    else
+                        tile->draw(transformPositionTo2D(tilePos, cameraPosition), scaleFactor, drawFlags, m_lightView.get());
+                }
 
-            if(drawFlags & Otc::DrawMissiles) {
-                for(const MissilePtr& missile : g_map.getFloorMissiles(z)) {
-                    missile->draw(transformPositionTo2D(missile->getPosition(), cameraPosition), scaleFactor, drawFlags & Otc::DrawAnimations, m_lightView.get());
+                if(drawFlags & Otc::DrawMissiles) {
+                    for(const MissilePtr& missile : g_map.getFloorMissiles(z)) {
+                        missile->draw(transformPositionTo2D(missile->getPosition(), cameraPosition), scaleFactor, drawFlags & Otc::DrawAnimations, m_lightView.get());
+                    }
                 }
             }
         }
@@ -208,6 +225,18 @@ void MapView::draw(const Rect& rect)
     g_painter->resetOpacity();
     glEnable(GL_BLEND);
 
+    // shaders, fades, moving texts, unfinished tile caches and texture uploads keep damaging the next frame,
+    // drawn animations damage it when their phase changes
+    if(m_shader || fadeOpacity < 1.0f || !g_map.getAnimatedTexts().empty() || m_updateTilesPos > 0 || g_things.getPendingTextures() > 0)
+        repaint();
+    else if(drawFlags & Otc::DrawAnimations) {
+        ticks_t nextAnimationFrame = g_map.getNextAnimationFrame();
+        if(nextAnimationFrame <= g_clock.millis())
+            repaint();
+        else if(nextAnimationFrame != std::numeric_limits<ticks_t>::max())
+            g_app.scheduleBackgroundRepaint(nextAnimationFrame - g_clock.millis());
+    }
+
 
     // this could happen if the player position is not known yet
     if(!cameraPosition.isValid())
@@ -244,6 +273,7 @@ void MapView::draw(const Rect& rect)
         m_lightView->draw(rect, srcRect);
 
     if(m_viewMode == NEAR_VIEW && m_drawTexts) {
+        ProfilerZone textZone("text");
         for(const StaticTextPtr& staticText : g_map.getStaticTexts()) {
             Position pos = staticText->getPosition();
 
@@ -285,6 +315,80 @@ void MapView::draw(const Rect& rect)
     }
 }
 
+void MapView::drawFloorsInParallel(const Position& cameraPosition, float scaleFactor, int drawFlags)
+{
+    // visible tiles are cached in floor draw order, split them in one range per floor
+    std::vector<std::pair<int, int>> floorRanges;
+    int size = m_cachedVisibleTiles.size();
+    for(int begin = 0, end = 0; begin < size; begin = end) {
+        int z = m_cachedVisibleTiles[begin]->getPosition().z;
+        while(end < size && m_cachedVisibleTiles[end]->getPosition().z == z)
+            ++end;
+        floorRanges.push_back(std::make_pair(begin, end));
+    }
+    if(floorRanges.empty())
+        return;
+
+    // workers prepare the upper floors while this thread prepares and submits the floors in order,
+    // a floor whose task has not started yet is claimed and prepared here instead of waited for
+    int count = floorRanges.size();
+    std::vector<DrawList> drawLists(count);
+    std::shared_ptr<std::vector<std::atomic<bool>>> claimed(new std::vector<std::atomic<bool>>(count));
+    for(std::atomic<bool>& floorClaimed : *claimed)
+        floorClaimed = false;
+    std::vector<boost::shared_future<bool>> prepared;
+    for(int i = 1; i < count; ++i) {
+        std::pair<int, int> range = floorRanges[i];
+        DrawList *drawList = &drawLists[i];
+        prepared.push_back(g_frameDispatcher.schedule([=]() -> bool {
+            if((*claimed)[i].exchange(true))
+                return false;
+            prepareFloorDraw(range.first, range.second, cameraPosition, scaleFactor, drawFlags, *drawList);
+            return true;
+        }));
+    }
+
+    for(int i = 0; i < count; ++i) {
+        if(!(*claimed)[i].exchange(true))
+            prepareFloorDraw(floorRanges[i].first, floorRanges[i].second, cameraPosition, scaleFactor, drawFlags, drawLists[i]);
+        else
+            prepared[i-1].wait();
+        submitDrawList(drawLists[i], scaleFactor);
+    }
+}
+
+void MapView::prepareFloorDraw(int begin, int end, const Position& cameraPosition, float scaleFactor, int drawFlags, DrawList& drawList)
+{
+    for(int i = begin; i < end; ++i) {
+        const TilePtr& tile = m_cachedVisibleTiles[i];
+        const Position& tilePos = tile->getPosition();
+        bool lit = !g_map.isCovered(tilePos, m_cachedFirstVisibleFloor);
+        tile->prepareDraw(transformPositionTo2D(tilePos, cameraPosition), scaleFactor, drawFlags, lit, drawList);
+    }
+}
+
+void MapView::submitDrawList(const DrawList& drawList, float scaleFactor)
+{
+    for(const DrawCommand& command : drawList) {
+        LightView *lightView = command.lit ? m_lightView.get() : nullptr;
+        if(!command.thingType) {
+            if(lightView) {
+                Light light;
+                light.intensity = 1;
+                lightView->addLightSource(command.dest, scaleFactor, light);
+            }
+            continue;
+        }
+
+        int animationPhase = command.animator ? command.animator->getPhase() : command.animationPhase;
+        g_painter->setColor(command.color);
+        g_painter->setOpacity(command.opacity);
+        command.thingType->draw(command.dest, scaleFactor, 0, command.xPattern, command.yPattern, command.zPattern, animationPhase, lightView);
+    }
+    g_painter->resetColor();
+    g_painter->resetOpacity();
+}
+
 void MapView::updateVisibleTilesCache(int start)
 {
     if(start == 0) {
@@ -479,6 +583,12 @@ void MapView::updateGeometry(const Size& visibleDimension, const Size& optimized
     requestVisibleTilesCacheUpdate();
 }
 
+void MapView::repaint()
+{
+    // map views are drawn in the background pane, changing one damages only that pane
+    g_app.repaintBackground();
+}
+
 void MapView::onTileUpdate(const Position&)
 {
     requestVisibleTilesCacheUpdate();
@@ -600,6 +710,8 @@ void MapView::move(int x, int y)
 
     if(requestTilesUpdate)
         requestVisibleTilesCacheUpdate();
+    else
+        repaint();
 }
 
 Rect MapView::calcFramebufferSource(const Size& destSize)
@@ -729,6 +841,7 @@ void MapView::setShader(const PainterShaderProgramPtr& shader, float fadein, flo
     m_fadeTimer.restart();
     m_fadeInTime = fadein;
     m_fadeOutTime = fadeout;
+    repaint();
 }
 
 
@@ -742,6 +855,7 @@ void MapView::setDrawLights(bool enable)
     else
         m_lightView = nullptr;
     m_drawLights = enable;
+    repaint();
 }
 
 /* vim: set ts=4 sw=4 et: */
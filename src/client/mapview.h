@@ -29,6 +29,7 @@
 #include <framework/luaengine/luaobject.h>
 #include <framework/core/declarations.h>
 #include "lightview.h"
+#include "drawlist.h"
 
 // @bindclass
 class MapView : public LuaObject
@@ -48,7 +49,8 @@ public:
 private:
     void updateGeometry(const Size& visibleDimension, const Size& optimizedSize);
     void updateVisibleTilesCache(int start = 0);
-    void requestVisibleTilesCacheUpdate() { m_mustUpdateVisibleTilesCache = true; }
+    void requestVisibleTilesCacheUpdate() { m_mustUpdateVisibleTilesCache = true; repaint(); }
+    void repaint();
 
 protected:
     void onTileUpdate(const Position& pos);
@@ -89,26 +91,26 @@ public:
     void setCameraPosition(const Position& pos);
     Position getCameraPosition();
 
-    void setMinimumAmbientLight(float intensity) { m_minimumAmbientLight = intensity; }
+    void setMinimumAmbientLight(float intensity) { m_minimumAmbientLight = intensity; repaint(); }
     float getMinimumAmbientLight() { return m_minimumAmbientLight; }
 
     // drawing related
     void setDrawFlags(Otc::DrawFlags drawFlags) { m_drawFlags = drawFlags; requestVisibleTilesCacheUpdate(); }
     Otc::DrawFlags getDrawFlags() { return m_drawFlags; }
 
-    void setDrawTexts(bool enable) { m_drawTexts = enable; }
+    void setDrawTexts(bool enable) { m_drawTexts = enable; repaint(); }
     bool isDrawingTexts() { return m_drawTexts; }
 
-    void setDrawNames(bool enable) { m_drawNames = enable; }
+    void setDrawNames(bool enable) { m_drawNames = enable; repaint(); }
     bool isDrawingNames() { return m_drawNames; }
 
-    void setDrawHealthBars(bool enable) { m_drawHealthBars = enable; }
+    void setDrawHealthBars(bool enable) { m_drawHealthBars = enable; repaint(); }
     bool isDrawingHealthBars() { return m_drawHealthBars; }
 
     void setDrawLights(bool enable);
     bool isDrawingLights() { return m_drawLights; }
 
-    void setDrawManaBar(bool enable) { m_drawManaBar = enable; }
+    void setDrawManaBar(bool enable) { m_drawManaBar = enable; repaint(); }
     bool isDrawingManaBar() { return m_drawManaBar; }
 
     void move(int x, int y);
@@ -116,7 +118,7 @@ public:
     void setAnimated(bool animated) { m_animated = animated; requestVisibleTilesCacheUpdate(); }
     bool isAnimating() { return m_animated; }
 
-    void setAddLightMethod(bool add) { m_lightView->setBlendEquation(add ? Painter::BlendEquation_Add : Painter::BlendEquation_Max); }
+    void setAddLightMethod(bool add) { m_lightView->setBlendEquation(add ? Painter::BlendEquation_Add : Painter::BlendEquation_Max); repaint(); }
 
     void setShader(const PainterShaderProgramPtr& shader, float fadein, float fadeout);
     PainterShaderProgramPtr getShader() { return m_shader; }
@@ -129,6 +131,9 @@ private:
     Rect calcFramebufferSource(const Size& destSize);
     int calcFirstVisibleFloor();
     int calcLastVisibleFloor();
+    void drawFloorsInParallel(const Position& cameraPosition, float scaleFactor, int drawFlags);
+    void prepareFloorDraw(int begin, int end, const Position& cameraPosition, float scaleFactor, int drawFlags, DrawList& drawList);
+    void submitDrawList(const DrawList& drawList, float scaleFactor);
     Point transformPositionTo2D(const Position& position, const Position& relativePosition) {
         return Point((m_virtualCenterOffset.x + (position.x - relativePosition.x) - (relativePosition.z - position.z)) * m_tileSize,
                      (m_virtualCenterOffset.y + (position.y - relativePosition.y) - (relativePosition.z - position.z)) * m_tileSize);
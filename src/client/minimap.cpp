@@ -31,6 +31,7 @@
 #include <framework/graphics/framebuffermanager.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
+#include <framework/core/application.h>
 #include <zlib.h>
 
 Minimap g_minimap;
@@ -77,8 +78,11 @@ void MinimapBlock::update()
 
 void MinimapBlock::updateTile(int x, int y, const MinimapTile& tile)
 {
-    if(m_tiles[getTileIndex(x,y)].color != tile.color)
+    // minimap widgets are drawn in the foreground, only a new color damages it
+    if(m_tiles[getTileIndex(x,y)].color != tile.color) {
         m_mustUpdate = true;
+        g_app.repaint();
+    }
 
     m_tiles[getTileIndex(x,y)] = tile;
 }
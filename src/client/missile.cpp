@@ -27,11 +27,19 @@
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
 
+stdext::object_pool<Missile>& Missile::getPool()
+{
+    static stdext::object_pool<Missile> *pool = new stdext::object_pool<Missile>;
+    return *pool;
+}
+
 void Missile::draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView)
 {
     if(m_id == 0 || !animate)
         return;
 
+    g_map.scheduleAnimationFrame(g_clock.millis());
+
     int xPattern = 0, yPattern = 0;
     if(m_direction == Otc::NorthWest) {
         xPattern = 0;
@@ -35,6 +35,10 @@ class Missile : public Thing
     };
 
 public:
+    void *operator new(size_t size) { return getPool().allocate(size); }
+    void operator delete(void *p, size_t size) { getPool().deallocate(p, size); }
+    static stdext::object_pool<Missile>& getPool();
+
     void draw(const Point& dest, float scaleFactor, bool animate, LightView *lightView = nullptr);
 
     void setId(uint32 id);
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "outfitcache.h"
+#include "outfit.h"
+#include <framework/graphics/framebuffer.h>
+#include <framework/graphics/framebuffermanager.h>
+#include <framework/graphics/graphics.h>
+
+OutfitCache g_outfitCache;
+
+std::size_t OutfitCache::FrameKeyHasher::operator()(const FrameKey& key) const
+{
+    uint64 clothes = (uint64)key.head | (uint64)key.body << 8 | (uint64)key.legs << 16 | (uint64)key.feet << 24 | (uint64)key.addons << 32;
+    uint64 frame = (uint64)key.type | (uint64)key.mount << 16 | (uint64)key.xPattern << 32 | (uint64)key.animationPhase << 40;
+    return std::hash<uint64>()(clothes * 0x9E3779B97F4A7C15ULL ^ frame);
+}
+
+void OutfitCache::init()
+{
+    m_enabled = false;
+    m_cacheSize = CACHE_SIZE;
+    m_hits = 0;
+    m_misses = 0;
+}
+
+void OutfitCache::terminate()
+{
+    clear();
+    m_freeFrames.clear();
+}
+
+const FrameBufferPtr& OutfitCache::getFrame(const Outfit& outfit, int xPattern, int animationPhase, bool& created)
+{
+    FrameKey key = { outfit.getId(), outfit.getMount(), outfit.getHead(), outfit.getBody(), outfit.getLegs(), outfit.getFeet(), outfit.getAddons(), xPattern, animationPhase };
+
+    auto it = m_framesIndex.find(key);
+    if(it != m_framesIndex.end()) {
+        m_frames.splice(m_frames.begin(), m_frames, it->second);
+        m_hits++;
+        created = false;
+        return it->second->second;
+    }
+
+    // framebuffers are owned by the framebuffer manager until termination, so they are always reused
+    if((int)m_frames.size() >= m_cacheSize)
+        releaseFrame();
+
+    FrameBufferPtr frame;
+    if(!m_freeFrames.empty()) {
+        frame = m_freeFrames.back();
+        m_freeFrames.pop_back();
+    } else {
+        frame = g_framebuffers.createFrameBuffer();
+        frame->resize(Size(FRAME_SIZE, FRAME_SIZE));
+    }
+
+    m_frames.emplace_front(key, frame);
+    m_framesIndex[key] = m_frames.begin();
+    m_misses++;
+    created = true;
+    return m_frames.front().second;
+}
+
+void OutfitCache::clear()
+{
+    while(!m_frames.empty())
+        releaseFrame();
+}
+
+void OutfitCache::setEnabled(bool enable)
+{
+    if(enable && !g_graphics.canUseFBO()) {
+        g_logger.error("unable to enable the outfit cache, framebuffers are not supported");
+        return;
+    }
+
+    m_enabled = enable;
+    if(!enable)
+        clear();
+}
+
+void OutfitCache::setCacheSize(int size)
+{
+    m_cacheSize = std::max<int>(size, 1);
+    while((int)m_frames.size() > m_cacheSize)
+        releaseFrame();
+}
+
+void OutfitCache::releaseFrame()
+{
+    m_freeFrames.push_back(m_frames.back().second);
+    m_framesIndex.erase(m_frames.back().first);
+    m_frames.pop_back();
+}
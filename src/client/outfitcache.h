@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef OUTFITCACHE_H
+#define OUTFITCACHE_H
+
+#include "declarations.h"
+#include <framework/graphics/declarations.h>
+
+// @bindsingleton g_outfitCache
+class OutfitCache
+{
+public:
+    enum {
+        CACHE_SIZE = 256,
+        FRAME_SIZE = 4 * Otc::TILE_PIXELS
+    };
+
+private:
+    struct FrameKey {
+        int type, mount, head, body, legs, feet, addons;
+        int xPattern, animationPhase;
+
+        bool operator==(const FrameKey& other) const {
+            return type == other.type && mount == other.mount &&
+                   head == other.head && body == other.body && legs == other.legs && feet == other.feet &&
+                   addons == other.addons && xPattern == other.xPattern && animationPhase == other.animationPhase;
+        }
+    };
+
+    struct FrameKeyHasher {
+        std::size_t operator()(const FrameKey& key) const;
+    };
+
+    // least recently used frames are at the back
+    typedef std::list<std::pair<FrameKey, FrameBufferPtr>> FrameList;
+
+public:
+    void init();
+    void terminate();
+
+    /// Returns the framebuffer holding the composited outfit frame, created is set when it was just
+    /// created and must be drawn by the caller
+    const FrameBufferPtr& getFrame(const Outfit& outfit, int xPattern, int animationPhase, bool& created);
+    void clear();
+
+    void setEnabled(bool enable);
+    void setCacheSize(int size);
+
+    bool isEnabled() { return m_enabled; }
+    int getCacheSize() { return m_cacheSize; }
+    int getCachedFrames() { return m_frames.size(); }
+    int getHits() { return m_hits; }
+    int getMisses() { return m_misses; }
+
+private:
+    void releaseFrame();
+
+    FrameList m_frames;
+    std::unordered_map<FrameKey, FrameList::iterator, FrameKeyHasher> m_framesIndex;
+    std::vector<FrameBufferPtr> m_freeFrames;
+    stdext::boolean<false> m_enabled;
+    int m_cacheSize;
+    int m_hits;
+    int m_misses;
+};
+
+extern OutfitCache g_outfitCache;
+
+#endif
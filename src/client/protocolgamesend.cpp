@@ -193,6 +193,7 @@ void ProtocolGame::sendAutoWalk(const std::vector<Otc::Direction>& path)
         msg->addU8(byte);
     }
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkNorth()
@@ -200,6 +201,7 @@ void ProtocolGame::sendWalkNorth()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkNorth);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkEast()
@@ -207,6 +209,7 @@ void ProtocolGame::sendWalkEast()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkEast);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkSouth()
@@ -214,6 +217,7 @@ void ProtocolGame::sendWalkSouth()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkSouth);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkWest()
@@ -221,6 +225,7 @@ void ProtocolGame::sendWalkWest()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkWest);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendStop()
@@ -228,6 +233,7 @@ void ProtocolGame::sendStop()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientStop);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkNorthEast()
@@ -235,6 +241,7 @@ void ProtocolGame::sendWalkNorthEast()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkNorthEast);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkSouthEast()
@@ -242,6 +249,7 @@ void ProtocolGame::sendWalkSouthEast()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkSouthEast);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkSouthWest()
@@ -249,6 +257,7 @@ void ProtocolGame::sendWalkSouthWest()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkSouthWest);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendWalkNorthWest()
@@ -256,6 +265,7 @@ void ProtocolGame::sendWalkNorthWest()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientWalkNorthWest);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendTurnNorth()
@@ -263,6 +273,7 @@ void ProtocolGame::sendTurnNorth()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientTurnNorth);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendTurnEast()
@@ -270,6 +281,7 @@ void ProtocolGame::sendTurnEast()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientTurnEast);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendTurnSouth()
@@ -277,6 +289,7 @@ void ProtocolGame::sendTurnSouth()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientTurnSouth);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendTurnWest()
@@ -284,6 +297,7 @@ void ProtocolGame::sendTurnWest()
     OutputMessagePtr msg(new OutputMessage);
     msg->addU8(Proto::ClientTurnWest);
     send(msg);
+    flush();
 }
 
 void ProtocolGame::sendEquipItem(int itemId, int countOrSubType)
@@ -28,6 +28,28 @@
 
 ShaderManager g_shaders;
 
+// colorizes the outfit masks in the same pass, each mask frame is at a fixed offset from the outfit frame
+static const std::string glslOutfitFragmentShader = "\n\
+    varying mediump vec2 v_TexCoord;\n\
+    uniform lowp vec4 u_Color;\n\
+    uniform sampler2D u_Tex0;\n\
+    uniform lowp vec4 u_HeadColor;\n\
+    uniform lowp vec4 u_BodyColor;\n\
+    uniform lowp vec4 u_LegsColor;\n\
+    uniform lowp vec4 u_FeetColor;\n\
+    uniform mediump vec2 u_HeadOffset;\n\
+    uniform mediump vec2 u_BodyOffset;\n\
+    uniform mediump vec2 u_LegsOffset;\n\
+    uniform mediump vec2 u_FeetOffset;\n\
+    lowp vec4 calculatePixel() {\n\
+        lowp vec4 pixel = texture2D(u_Tex0, v_TexCoord);\n\
+        lowp vec3 color = mix(vec3(1.0), u_HeadColor.rgb, texture2D(u_Tex0, v_TexCoord + u_HeadOffset).a);\n\
+        color *= mix(vec3(1.0), u_BodyColor.rgb, texture2D(u_Tex0, v_TexCoord + u_BodyOffset).a);\n\
+        color *= mix(vec3(1.0), u_LegsColor.rgb, texture2D(u_Tex0, v_TexCoord + u_LegsOffset).a);\n\
+        color *= mix(vec3(1.0), u_FeetColor.rgb, texture2D(u_Tex0, v_TexCoord + u_FeetOffset).a);\n\
+        return vec4(pixel.rgb * color, pixel.a) * u_Color;\n\
+    }\n";
+
 void ShaderManager::init()
 {
     if(!g_graphics.canUseShaders())
@@ -38,6 +60,9 @@ void ShaderManager::init()
 
     m_defaultMapShader = createFragmentShaderFromCode("Map", glslMainFragmentShader + glslTextureSrcFragmentShader);
 
+    m_outfitShader = createFragmentShaderFromCode("Outfit", glslMainFragmentShader + glslOutfitFragmentShader);
+    setupOutfitShader(m_outfitShader);
+
     PainterShaderProgram::release();
 }
 
@@ -45,6 +70,7 @@ void ShaderManager::terminate()
 {
     m_defaultItemShader = nullptr;
     m_defaultMapShader = nullptr;
+    m_outfitShader = nullptr;
     m_shaders.clear();
 }
 
@@ -136,6 +162,20 @@ void ShaderManager::setupMapShader(const PainterShaderProgramPtr& shader)
     shader->bindUniformLocation(MAP_ZOOM, "u_MapZoom");
 }
 
+void ShaderManager::setupOutfitShader(const PainterShaderProgramPtr& shader)
+{
+    if(!shader)
+        return;
+    shader->bindUniformLocation(OUTFIT_HEAD_COLOR, "u_HeadColor");
+    shader->bindUniformLocation(OUTFIT_BODY_COLOR, "u_BodyColor");
+    shader->bindUniformLocation(OUTFIT_LEGS_COLOR, "u_LegsColor");
+    shader->bindUniformLocation(OUTFIT_FEET_COLOR, "u_FeetColor");
+    shader->bindUniformLocation(OUTFIT_HEAD_OFFSET, "u_HeadOffset");
+    shader->bindUniformLocation(OUTFIT_BODY_OFFSET, "u_BodyOffset");
+    shader->bindUniformLocation(OUTFIT_LEGS_OFFSET, "u_LegsOffset");
+    shader->bindUniformLocation(OUTFIT_FEET_OFFSET, "u_FeetOffset");
+}
+
 PainterShaderProgramPtr ShaderManager::getShader(const std::string& name)
 {
     auto it = m_shaders.find(name);
@@ -34,7 +34,15 @@ public:
         ITEM_ID_UNIFORM = 10,
         MAP_CENTER_COORD = 10,
         MAP_GLOBAL_COORD = 11,
-        MAP_ZOOM = 12
+        MAP_ZOOM = 12,
+        OUTFIT_HEAD_COLOR = 10,
+        OUTFIT_BODY_COLOR = 11,
+        OUTFIT_LEGS_COLOR = 12,
+        OUTFIT_FEET_COLOR = 13,
+        OUTFIT_HEAD_OFFSET = 14,
+        OUTFIT_BODY_OFFSET = 15,
+        OUTFIT_LEGS_OFFSET = 16,
+        OUTFIT_FEET_OFFSET = 17
     };
 
     void init();
@@ -49,15 +57,18 @@ public:
 
     const PainterShaderProgramPtr& getDefaultItemShader() { return m_defaultItemShader; }
     const PainterShaderProgramPtr& getDefaultMapShader() { return m_defaultMapShader; }
+    const PainterShaderProgramPtr& getOutfitShader() { return m_outfitShader; }
 
     PainterShaderProgramPtr getShader(const std::string& name);
 
 private:
     void setupItemShader(const PainterShaderProgramPtr& shader);
     void setupMapShader(const PainterShaderProgramPtr& shader);
+    void setupOutfitShader(const PainterShaderProgramPtr& shader);
 
     PainterShaderProgramPtr m_defaultItemShader;
     PainterShaderProgramPtr m_defaultMapShader;
+    PainterShaderProgramPtr m_outfitShader;
     std::unordered_map<std::string, PainterShaderProgramPtr> m_shaders;
 };
 
@@ -22,6 +22,7 @@
 
 #include "spritemanager.h"
 #include "game.h"
+#include "thingtypemanager.h"
 #include <framework/core/resourcemanager.h>
 #include <framework/core/filestream.h>
 #include <framework/graphics/image.h>
@@ -44,23 +45,27 @@ bool SpriteManager::loadSpr(std::string file)
     m_spritesCount = 0;
     m_signature = 0;
     m_loaded = false;
+    g_things.cancelTextures();
     try {
         file = g_resources.guessFilePath(file, "spr");
 
-        m_spritesFile = g_resources.openFile(file);
+        FileStreamPtr spritesFile = g_resources.openFile(file);
         // cache file buffer to avoid lags from hard drive
-        m_spritesFile->cache();
+        spritesFile->cache();
 
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_spritesFile = spritesFile;
         m_signature = m_spritesFile->getU32();
         m_spritesCount = g_game.getFeature(Otc::GameSpritesU32) ? m_spritesFile->getU32() : m_spritesFile->getU16();
         m_spritesOffset = m_spritesFile->tell();
         m_loaded = true;
-        g_lua.callGlobalField("g_sprites", "onLoadSpr", file);
-        return true;
     } catch(stdext::exception& e) {
         g_logger.error(stdext::format("Failed to load sprites from '%s': %s", file, e.what()));
         return false;
     }
+
+    g_lua.callGlobalField("g_sprites", "onLoadSpr", file);
+    return true;
 }
 
 void SpriteManager::saveSpr(std::string fileName)
@@ -69,6 +74,7 @@ void SpriteManager::saveSpr(std::string fileName)
         stdext::throw_exception("failed to save, spr is not loaded");
 
     try {
+        std::lock_guard<std::mutex> lock(m_mutex);
         FileStreamPtr fin = g_resources.createFile(fileName);
         if(!fin)
             stdext::throw_exception(stdext::format("failed to open file '%s' for write", fileName));
@@ -119,47 +125,72 @@ void SpriteManager::saveSpr(std::string fileName)
 
 void SpriteManager::unload()
 {
+    g_things.cancelTextures();
+    std::lock_guard<std::mutex> lock(m_mutex);
     m_spritesCount = 0;
     m_signature = 0;
     m_spritesFile = nullptr;
 }
 
-ImagePtr SpriteManager::getSpriteImage(int id)
+bool SpriteManager::readSpriteData(int id, std::vector<uint8>& data)
 {
-    try {
+    // sprites are decoded by the async dispatcher too, only the file access is serialized
+    std::lock_guard<std::mutex> lock(m_mutex);
 
-        if(id == 0 || !m_spritesFile)
-            return nullptr;
+    if(id == 0 || !m_spritesFile)
+        return false;
 
-        m_spritesFile->seek(((id-1) * 4) + m_spritesOffset);
+    m_spritesFile->seek(((id-1) * 4) + m_spritesOffset);
 
-        uint32 spriteAddress = m_spritesFile->getU32();
+    uint32 spriteAddress = m_spritesFile->getU32();
 
-        // no sprite? return an empty texture
-        if(spriteAddress == 0)
-            return nullptr;
+    // no sprite? return an empty texture
+    if(spriteAddress == 0)
+        return false;
 
-        m_spritesFile->seek(spriteAddress);
+    m_spritesFile->seek(spriteAddress);
 
-        // skip color key
-        m_spritesFile->getU8();
-        m_spritesFile->getU8();
-        m_spritesFile->getU8();
+    // skip color key
+    m_spritesFile->getU8();
+    m_spritesFile->getU8();
+    m_spritesFile->getU8();
 
-        uint16 pixelDataSize = m_spritesFile->getU16();
+    uint16 pixelDataSize = m_spritesFile->getU16();
+    data.resize(pixelDataSize);
+    if(pixelDataSize > 0 && m_spritesFile->read(data.data(), pixelDataSize) != 1)
+        stdext::throw_exception("sprite data is truncated");
+    return true;
+}
+
+ImagePtr SpriteManager::getSpriteImage(int id)
+{
+    std::string error;
+    ImagePtr image = getSpriteImage(id, error);
+    if(!error.empty())
+        g_logger.error(error);
+    return image;
+}
+
+ImagePtr SpriteManager::getSpriteImage(int id, std::string& error)
+{
+    try {
+        std::vector<uint8> data;
+        if(!readSpriteData(id, data))
+            return nullptr;
 
         ImagePtr image(new Image(Size(SPRITE_SIZE, SPRITE_SIZE)));
 
         uint8 *pixels = image->getPixelData();
         int writePos = 0;
-        int read = 0;
+        uint read = 0;
         bool useAlpha = g_game.getFeature(Otc::GameSpritesAlphaChannel);
         uint8 channels = useAlpha ? 4 : 3;
 
         // decompress pixels
-        while(read < pixelDataSize && writePos < SPRITE_DATA_SIZE) {
-            uint16 transparentPixels = m_spritesFile->getU16();
-            uint16 coloredPixels = m_spritesFile->getU16();
+        while(read + 4 <= data.size() && writePos < SPRITE_DATA_SIZE) {
+            uint16 transparentPixels = stdext::readULE16(&data[read]);
+            uint16 coloredPixels = stdext::readULE16(&data[read + 2]);
+            read += 4;
 
             for(int i = 0; i < transparentPixels && writePos < SPRITE_DATA_SIZE; i++) {
                 pixels[writePos + 0] = 0x00;
@@ -169,15 +200,17 @@ ImagePtr SpriteManager::getSpriteImage(int id)
                 writePos += 4;
             }
 
+            if(read + channels * coloredPixels > data.size())
+                stdext::throw_exception("sprite data is truncated");
+
             for(int i = 0; i < coloredPixels && writePos < SPRITE_DATA_SIZE; i++) {
-                pixels[writePos + 0] = m_spritesFile->getU8();
-                pixels[writePos + 1] = m_spritesFile->getU8();
-                pixels[writePos + 2] = m_spritesFile->getU8();
-                pixels[writePos + 3] = useAlpha ? m_spritesFile->getU8() : 0xFF;
+                pixels[writePos + 0] = data[read + 0];
+                pixels[writePos + 1] = data[read + 1];
+                pixels[writePos + 2] = data[read + 2];
+                pixels[writePos + 3] = useAlpha ? data[read + 3] : 0xFF;
                 writePos += 4;
+                read += channels;
             }
-
-            read += 4 + (channels * coloredPixels);
         }
 
         // fill remaining pixels with alpha
@@ -191,8 +224,7 @@ ImagePtr SpriteManager::getSpriteImage(int id)
 
         return image;
     } catch(stdext::exception& e) {
-        g_logger.error(stdext::format("Failed to get sprite id %d: %s", id, e.what()));
+        error = stdext::format("Failed to get sprite id %d: %s", id, e.what());
         return nullptr;
     }
 }
-
@@ -48,14 +48,18 @@ public:
     int getSpritesCount() { return m_spritesCount; }
 
     ImagePtr getSpriteImage(int id);
+    ImagePtr getSpriteImage(int id, std::string& error);
     bool isLoaded() { return m_loaded; }
 
 private:
+    bool readSpriteData(int id, std::vector<uint8>& data);
+
     stdext::boolean<false> m_loaded;
     uint32 m_signature;
     int m_spritesCount;
     int m_spritesOffset;
     FileStreamPtr m_spritesFile;
+    std::mutex m_mutex;
 };
 
 extern SpriteManager g_sprites;
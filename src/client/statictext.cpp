@@ -24,6 +24,7 @@
 #include "map.h"
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/application.h>
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/fontmanager.h>
 
@@ -101,6 +102,7 @@ void StaticText::update()
     } else {
         compose();
         scheduleUpdate();
+        g_app.repaintBackground();
     }
 }
 
@@ -22,8 +22,11 @@
 
 #include "thingtype.h"
 #include "spritemanager.h"
+#include "thingtypemanager.h"
 #include "game.h"
 #include "lightview.h"
+#include "outfit.h"
+#include "shadermanager.h"
 
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/texture.h>
@@ -37,6 +40,8 @@ ThingType::ThingType()
     m_category = ThingInvalidCategory;
     m_id = 0;
     m_null = true;
+    m_flags = 0;
+    memset(m_attrValues, 0, sizeof(m_attrValues));
     m_exactSize = 0;
     m_realSize = 0;
     m_animator = nullptr;
@@ -47,6 +52,11 @@ ThingType::ThingType()
     m_opacity = 1.0f;
 }
 
+ThingType::~ThingType()
+{
+    unloadTextures();
+}
+
 void ThingType::serialize(const FileStreamPtr& fin)
 {
     for(int i = 0; i < ThingLastAttr; ++i) {
@@ -74,13 +84,12 @@ void ThingType::serialize(const FileStreamPtr& fin)
                 break;
             }
             case ThingAttrLight: {
-                Light light = m_attribs.get<Light>(attr);
-                fin->addU16(light.intensity);
-                fin->addU16(light.color);
+                fin->addU16(m_light.intensity);
+                fin->addU16(m_light.color);
                 break;
             }
             case ThingAttrMarket: {
-                MarketData market = m_attribs.get<MarketData>(attr);
+                MarketData market = getMarketData();
                 fin->addU16(market.category);
                 fin->addU16(market.tradeAs);
                 fin->addU16(market.showAs);
@@ -97,7 +106,7 @@ void ThingType::serialize(const FileStreamPtr& fin)
             case ThingAttrMinimapColor:
             case ThingAttrCloth:
             case ThingAttrLensHelp:
-                fin->addU16(m_attribs.get<uint16>(attr));
+                fin->addU16(getAttrValue(attr));
                 break;
             default:
                 break;
@@ -167,7 +176,7 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
              * "Item Charges" flag.
              */
             if(attr == 8) {
-                m_attribs.set(ThingAttrChargeable, true);
+                setAttr(ThingAttrChargeable);
                 continue;
             } else if(attr > 8)
                 attr -= 1;
@@ -223,14 +232,13 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
                     m_displacement.x = 8;
                     m_displacement.y = 8;
                 }
-                m_attribs.set(attr, true);
+                setAttr(attr);
                 break;
             }
             case ThingAttrLight: {
-                Light light;
-                light.intensity = fin->getU16();
-                light.color = fin->getU16();
-                m_attribs.set(attr, light);
+                m_light.intensity = fin->getU16();
+                m_light.color = fin->getU16();
+                setAttr(attr);
                 break;
             }
             case ThingAttrMarket: {
@@ -241,12 +249,13 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
                 market.name = fin->getString();
                 market.restrictVocation = fin->getU16();
                 market.requiredLevel = fin->getU16();
-                m_attribs.set(attr, market);
+                m_marketData.reset(new MarketData(market));
+                setAttr(attr);
                 break;
             }
             case ThingAttrElevation: {
                 m_elevation = fin->getU16();
-                m_attribs.set(attr, m_elevation);
+                setAttr(attr);
                 break;
             }
             case ThingAttrUsable:
@@ -256,10 +265,10 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
             case ThingAttrMinimapColor:
             case ThingAttrCloth:
             case ThingAttrLensHelp:
-                m_attribs.set(attr, fin->getU16());
+                setAttrValue(attr, fin->getU16());
                 break;
             default:
-                m_attribs.set(attr, true);
+                setAttr(attr);
                 break;
         };
     }
@@ -317,7 +326,150 @@ void ThingType::unserialize(uint16 clientId, ThingCategory category, const FileS
         totalSpritesCount += totalSprites;
     }
 
+    unloadTextures();
+    m_textures.resize(m_animationPhases);
+    m_texturesUsage.resize(m_animationPhases);
+    m_texturesFramesRects.resize(m_animationPhases);
+    m_texturesFramesOriginRects.resize(m_animationPhases);
+    m_texturesFramesOffsets.resize(m_animationPhases);
+}
+
+void ThingType::serializeSnapshot(const FileStreamPtr& fin)
+{
+    // attributes are stored already remapped to this client version, so loading them needs no version checks
+    for(int i = 0; i < ThingLastAttr; ++i) {
+        if(!hasAttr((ThingAttr)i))
+            continue;
+
+        fin->addU8(i);
+        switch(i) {
+            case ThingAttrLight: {
+                fin->addU8(m_light.intensity);
+                fin->addU8(m_light.color);
+                break;
+            }
+            case ThingAttrMarket: {
+                MarketData market = getMarketData();
+                fin->addU16(market.category);
+                fin->addU16(market.tradeAs);
+                fin->addU16(market.showAs);
+                fin->addString(market.name);
+                fin->addU16(market.restrictVocation);
+                fin->addU16(market.requiredLevel);
+                break;
+            }
+            case ThingAttrElevation:
+                fin->addU16(m_elevation);
+                break;
+            case ThingAttrUsable:
+            case ThingAttrGround:
+            case ThingAttrWritable:
+            case ThingAttrWritableOnce:
+            case ThingAttrMinimapColor:
+            case ThingAttrCloth:
+            case ThingAttrLensHelp:
+                fin->addU16(getAttrValue(i));
+                break;
+            default:
+                break;
+        }
+    }
+    fin->addU8(ThingLastAttr);
+
+    fin->add16(m_displacement.x);
+    fin->add16(m_displacement.y);
+    fin->addU8(m_size.width());
+    fin->addU8(m_size.height());
+    fin->addU8(m_realSize);
+    fin->addU16(m_exactSize);
+    fin->addU8(m_layers);
+    fin->addU8(m_numPatternX);
+    fin->addU8(m_numPatternY);
+    fin->addU8(m_numPatternZ);
+    fin->addU16(m_animationPhases);
+
+    fin->addU8(m_animator ? 1 : 0);
+    if(m_animator) {
+        fin->addU16(m_animator->getAnimationPhases());
+        m_animator->serialize(fin);
+    }
+
+    fin->addU16(m_spritesIndex.size());
+    for(int i : m_spritesIndex)
+        fin->addU32(i);
+}
+
+void ThingType::unserializeSnapshot(uint16 clientId, ThingCategory category, const FileStreamPtr& fin)
+{
+    m_null = false;
+    m_id = clientId;
+    m_category = category;
+
+    for(int attr = fin->getU8(); attr != ThingLastAttr; attr = fin->getU8()) {
+        switch(attr) {
+            case ThingAttrLight: {
+                m_light.intensity = fin->getU8();
+                m_light.color = fin->getU8();
+                setAttr(attr);
+                break;
+            }
+            case ThingAttrMarket: {
+                MarketData market;
+                market.category = fin->getU16();
+                market.tradeAs = fin->getU16();
+                market.showAs = fin->getU16();
+                market.name = fin->getString();
+                market.restrictVocation = fin->getU16();
+                market.requiredLevel = fin->getU16();
+                m_marketData.reset(new MarketData(market));
+                setAttr(attr);
+                break;
+            }
+            case ThingAttrElevation:
+                m_elevation = fin->getU16();
+                setAttr(attr);
+                break;
+            case ThingAttrUsable:
+            case ThingAttrGround:
+            case ThingAttrWritable:
+            case ThingAttrWritableOnce:
+            case ThingAttrMinimapColor:
+            case ThingAttrCloth:
+            case ThingAttrLensHelp:
+                setAttrValue(attr, fin->getU16());
+                break;
+            default:
+                setAttr(attr);
+                break;
+        }
+    }
+
+    m_displacement.x = fin->get16();
+    m_displacement.y = fin->get16();
+    int width = fin->getU8();
+    int height = fin->getU8();
+    m_size = Size(width, height);
+    m_realSize = fin->getU8();
+    m_exactSize = fin->getU16();
+    m_layers = fin->getU8();
+    m_numPatternX = fin->getU8();
+    m_numPatternY = fin->getU8();
+    m_numPatternZ = fin->getU8();
+    m_animationPhases = fin->getU16();
+
+    if(fin->getU8()) {
+        int animationPhases = fin->getU16();
+        m_animator = AnimatorPtr(new Animator);
+        m_animator->unserialize(animationPhases, fin);
+    }
+
+    m_spritesIndex.resize(fin->getU16());
+    for(int& spriteId : m_spritesIndex)
+        spriteId = fin->getU32();
+
+    unloadTextures();
     m_textures.resize(m_animationPhases);
+    m_texturesUsage.resize(m_animationPhases);
     m_texturesFramesRects.resize(m_animationPhases);
     m_texturesFramesOriginRects.resize(m_animationPhases);
     m_texturesFramesOffsets.resize(m_animationPhases);
@@ -358,15 +510,19 @@ void ThingType::unserializeOtml(const OTMLNodePtr& node)
     for(const OTMLNodePtr& node2 : node->children()) {
         if(node2->tag() == "opacity")
             m_opacity = node2->value<float>();
-        else if(node2->tag() == "notprewalkable")
-            m_attribs.set(ThingAttrNotPreWalkable, node2->value<bool>());
+        else if(node2->tag() == "notprewalkable") {
+            if(node2->value<bool>())
+                setAttr(ThingAttrNotPreWalkable);
+            else
+                removeAttr(ThingAttrNotPreWalkable);
+        }
         else if(node2->tag() == "image")
             m_customImage = node2->value();
         else if(node2->tag() == "full-ground") {
             if(node2->value<bool>())
-                m_attribs.set(ThingAttrFullGround, true);
+                setAttr(ThingAttrFullGround);
             else
-                m_attribs.remove(ThingAttrFullGround);
+                removeAttr(ThingAttrFullGround);
         }
     }
 }
@@ -379,9 +535,13 @@ void ThingType::draw(const Point& dest, float scaleFactor, int layer, int xPatte
     if(animationPhase >= m_animationPhases)
         return;
 
-    const TexturePtr& texture = getTexture(animationPhase); // texture might not exists, neither its rects.
-    if(!texture)
-        return;
+    // texture might not exists, neither its rects.
+    if(!getTexture(animationPhase, true)) {
+        animationPhase = getPlaceholderPhase(animationPhase);
+        if(animationPhase < 0)
+            return;
+    }
+    const TexturePtr& texture = m_textures[animationPhase];
 
     uint frameIndex = getTextureIndex(layer, xPattern, yPattern, zPattern);
     if(frameIndex >= m_texturesFramesRects[animationPhase].size())
@@ -413,92 +573,238 @@ void ThingType::draw(const Point& dest, float scaleFactor, int layer, int xPatte
     if(lightView && hasLight()) {
         Light light = getLight();
         if(light.intensity > 0)
-            lightView->addLightSource(screenRect.center(), scaleFactor, light);
+            lightView->addLightSource(screenRect.center(), scaleFactor, light, m_category != ThingCategoryItem);
     }
 }
 
-const TexturePtr& ThingType::getTexture(int animationPhase)
+void ThingType::drawOutfit(const Point& dest, float scaleFactor, int xPattern, int yPattern, int zPattern, int animationPhase, const Outfit& outfit, LightView *lightView)
+{
+    if(m_category != ThingCategoryCreature || m_layers <= 1) {
+        draw(dest, scaleFactor, 0, xPattern, yPattern, zPattern, animationPhase, lightView);
+        return;
+    }
+
+    const PainterShaderProgramPtr& shader = g_shaders.getOutfitShader();
+    if(!shader || !g_painter->hasShaders() || !g_graphics.shouldUseShaders()) {
+        draw(dest, scaleFactor, 0, xPattern, yPattern, zPattern, animationPhase, lightView);
+
+        Color oldColor = g_painter->getColor();
+        Painter::CompositionMode oldComposition = g_painter->getCompositionMode();
+        g_painter->setCompositionMode(Painter::CompositionMode_Multiply);
+        g_painter->setColor(outfit.getHeadColor());
+        draw(dest, scaleFactor, SpriteMaskYellow, xPattern, yPattern, zPattern, animationPhase);
+        g_painter->setColor(outfit.getBodyColor());
+        draw(dest, scaleFactor, SpriteMaskRed, xPattern, yPattern, zPattern, animationPhase);
+        g_painter->setColor(outfit.getLegsColor());
+        draw(dest, scaleFactor, SpriteMaskGreen, xPattern, yPattern, zPattern, animationPhase);
+        g_painter->setColor(outfit.getFeetColor());
+        draw(dest, scaleFactor, SpriteMaskBlue, xPattern, yPattern, zPattern, animationPhase);
+        g_painter->setColor(oldColor);
+        g_painter->setCompositionMode(oldComposition);
+        return;
+    }
+
+    if(m_null || animationPhase >= m_animationPhases)
+        return;
+
+    if(!getTexture(animationPhase, true)) {
+        animationPhase = getPlaceholderPhase(animationPhase);
+        if(animationPhase < 0)
+            return;
+    }
+    const TexturePtr& texture = m_textures[animationPhase];
+
+    uint frameIndex = getTextureIndex(0, xPattern, yPattern, zPattern);
+    if(frameIndex >= m_texturesFramesOriginRects[animationPhase].size())
+        return;
+
+    // masks frames have the same layout of the outfit frame, so they are sampled at a constant offset
+    const Point framePos = m_texturesFramesOriginRects[animationPhase][frameIndex].topLeft();
+    const Size& textureSize = texture->getGlSize();
+    auto maskOffset = [&](int mask) {
+        Point offset = m_texturesFramesOriginRects[animationPhase][getTextureIndex(mask, xPattern, yPattern, zPattern)].topLeft() - framePos;
+        return PointF(offset.x / (float)textureSize.width(), offset.y / (float)textureSize.height());
+    };
+    PointF headOffset = maskOffset(SpriteMaskYellow);
+    PointF bodyOffset = maskOffset(SpriteMaskRed);
+    PointF legsOffset = maskOffset(SpriteMaskGreen);
+    PointF feetOffset = maskOffset(SpriteMaskBlue);
+
+    shader->bind();
+    shader->setUniformValue(ShaderManager::OUTFIT_HEAD_COLOR, outfit.getHeadColor());
+    shader->setUniformValue(ShaderManager::OUTFIT_BODY_COLOR, outfit.getBodyColor());
+    shader->setUniformValue(ShaderManager::OUTFIT_LEGS_COLOR, outfit.getLegsColor());
+    shader->setUniformValue(ShaderManager::OUTFIT_FEET_COLOR, outfit.getFeetColor());
+    shader->setUniformValue(ShaderManager::OUTFIT_HEAD_OFFSET, headOffset.x, headOffset.y);
+    shader->setUniformValue(ShaderManager::OUTFIT_BODY_OFFSET, bodyOffset.x, bodyOffset.y);
+    shader->setUniformValue(ShaderManager::OUTFIT_LEGS_OFFSET, legsOffset.x, legsOffset.y);
+    shader->setUniformValue(ShaderManager::OUTFIT_FEET_OFFSET, feetOffset.x, feetOffset.y);
+    g_painter->setShaderProgram(shader);
+    draw(dest, scaleFactor, 0, xPattern, yPattern, zPattern, animationPhase, lightView);
+    g_painter->resetShaderProgram();
+}
+
+const TexturePtr& ThingType::getTexture(int animationPhase, bool async)
 {
     TexturePtr& animationPhaseTexture = m_textures[animationPhase];
-    if(!animationPhaseTexture) {
-        bool useCustomImage = false;
-        if(animationPhase == 0 && !m_customImage.empty())
-            useCustomImage = true;
-
-        // we don't need layers in common items, they will be pre-drawn
-        int textureLayers = 1;
-        int numLayers = m_layers;
-        if(m_category == ThingCategoryCreature && numLayers >= 2) {
-             // 5 layers: outfit base, red mask, green mask, blue mask, yellow mask
-            textureLayers = 5;
-            numLayers = 5;
+    if(animationPhaseTexture)
+        g_things.touchTexture(m_texturesUsage[animationPhase]);
+    else if(async && !isGround() && !isFullGround() && (animationPhase != 0 || m_customImage.empty())) {
+        // sprites are decoded by the async dispatcher, grounds are built right away so the floor never has holes
+        g_things.requestTexture(this, animationPhase);
+    } else {
+        ThingTextureDataPtr data = g_things.waitTexture(this, animationPhase);
+        if(!data) {
+            data = buildTexture(animationPhase);
+            if(!data->error.empty())
+                g_logger.error(data->error);
         }
+        loadTexture(animationPhase, data);
+    }
+    return animationPhaseTexture;
+}
 
-        int indexSize = textureLayers * m_numPatternX * m_numPatternY * m_numPatternZ;
-        Size textureSize = getBestTextureDimension(m_size.width(), m_size.height(), indexSize);
-        ImagePtr fullImage;
+int ThingType::getPlaceholderPhase(int animationPhase)
+{
+    // while a phase is being built the closest previous phase already uploaded is drawn in its place
+    for(int i = 1; i < m_animationPhases; ++i) {
+        int phase = (animationPhase - i + m_animationPhases) % m_animationPhases;
+        if(m_textures[phase])
+            return phase;
+    }
+    return -1;
+}
 
-        if(useCustomImage)
-            fullImage = Image::load(m_customImage);
-        else
-            fullImage = ImagePtr(new Image(textureSize * Otc::TILE_PIXELS));
-
-        m_texturesFramesRects[animationPhase].resize(indexSize);
-        m_texturesFramesOriginRects[animationPhase].resize(indexSize);
-        m_texturesFramesOffsets[animationPhase].resize(indexSize);
-
-        for(int z = 0; z < m_numPatternZ; ++z) {
-            for(int y = 0; y < m_numPatternY; ++y) {
-                for(int x = 0; x < m_numPatternX; ++x) {
-                    for(int l = 0; l < numLayers; ++l) {
-                        bool spriteMask = (m_category == ThingCategoryCreature && l > 0);
-                        int frameIndex = getTextureIndex(l % textureLayers, x, y, z);
-                        Point framePos = Point(frameIndex % (textureSize.width() / m_size.width()) * m_size.width(),
-                                               frameIndex / (textureSize.width() / m_size.width()) * m_size.height()) * Otc::TILE_PIXELS;
-
-                        if(!useCustomImage) {
-                            for(int h = 0; h < m_size.height(); ++h) {
-                                for(int w = 0; w < m_size.width(); ++w) {
-                                    uint spriteIndex = getSpriteIndex(w, h, spriteMask ? 1 : l, x, y, z, animationPhase);
-                                    ImagePtr spriteImage = g_sprites.getSpriteImage(m_spritesIndex[spriteIndex]);
-                                    if(spriteImage) {
-                                        if(spriteMask) {
-                                            static Color maskColors[] = { Color::red, Color::green, Color::blue, Color::yellow };
-                                            spriteImage->overwriteMask(maskColors[l - 1]);
-                                        }
-                                        Point spritePos = Point(m_size.width()  - w - 1,
-                                                                m_size.height() - h - 1) * Otc::TILE_PIXELS;
-
-                                        fullImage->blit(framePos + spritePos, spriteImage);
+void ThingType::prefetchTextures()
+{
+    // only the first phase is prefetched, the others are requested when they are first drawn
+    if(m_null || !m_customImage.empty() || m_textures[0])
+        return;
+
+    g_things.requestTexture(this, 0);
+}
+
+ThingTextureDataPtr ThingType::buildTexture(int animationPhase)
+{
+    // custom images are loaded through the resource manager, so they must be built in the main thread
+    bool useCustomImage = false;
+    if(animationPhase == 0 && !m_customImage.empty())
+        useCustomImage = true;
+
+    // we don't need layers in common items, they will be pre-drawn
+    int textureLayers = 1;
+    int numLayers = m_layers;
+    if(m_category == ThingCategoryCreature && numLayers >= 2) {
+         // 5 layers: outfit base, red mask, green mask, blue mask, yellow mask
+        textureLayers = 5;
+        numLayers = 5;
+    }
+
+    int indexSize = textureLayers * m_numPatternX * m_numPatternY * m_numPatternZ;
+    Size textureSize = getBestTextureDimension(m_size.width(), m_size.height(), indexSize);
+    ImagePtr fullImage;
+
+    if(useCustomImage)
+        fullImage = Image::load(m_customImage);
+    else
+        fullImage = ImagePtr(new Image(textureSize * Otc::TILE_PIXELS));
+
+    ThingTextureDataPtr data = std::make_shared<ThingTextureData>();
+    data->framesRects.resize(indexSize);
+    data->framesOriginRects.resize(indexSize);
+    data->framesOffsets.resize(indexSize);
+
+    for(int z = 0; z < m_numPatternZ; ++z) {
+        for(int y = 0; y < m_numPatternY; ++y) {
+            for(int x = 0; x < m_numPatternX; ++x) {
+                for(int l = 0; l < numLayers; ++l) {
+                    bool spriteMask = (m_category == ThingCategoryCreature && l > 0);
+                    int frameIndex = getTextureIndex(l % textureLayers, x, y, z);
+                    Point framePos = Point(frameIndex % (textureSize.width() / m_size.width()) * m_size.width(),
+                                           frameIndex / (textureSize.width() / m_size.width()) * m_size.height()) * Otc::TILE_PIXELS;
+
+                    if(!useCustomImage) {
+                        for(int h = 0; h < m_size.height(); ++h) {
+                            for(int w = 0; w < m_size.width(); ++w) {
+                                uint spriteIndex = getSpriteIndex(w, h, spriteMask ? 1 : l, x, y, z, animationPhase);
+                                std::string error;
+                                ImagePtr spriteImage = g_sprites.getSpriteImage(m_spritesIndex[spriteIndex], error);
+                                if(!error.empty() && data->error.empty())
+                                    data->error = error;
+                                if(spriteImage) {
+                                    if(spriteMask) {
+                                        static const Color maskColors[] = { Color::red, Color::green, Color::blue, Color::yellow };
+                                        spriteImage->overwriteMask(maskColors[l - 1]);
                                     }
+                                    Point spritePos = Point(m_size.width()  - w - 1,
+                                                            m_size.height() - h - 1) * Otc::TILE_PIXELS;
+
+                                    fullImage->blit(framePos + spritePos, spriteImage);
                                 }
                             }
                         }
+                    }
 
-                        Rect drawRect(framePos + Point(m_size.width(), m_size.height()) * Otc::TILE_PIXELS - Point(1,1), framePos);
-                        for(int fx = framePos.x; fx < framePos.x + m_size.width() * Otc::TILE_PIXELS; ++fx) {
-                            for(int fy = framePos.y; fy < framePos.y + m_size.height() * Otc::TILE_PIXELS; ++fy) {
-                                uint8 *p = fullImage->getPixel(fx,fy);
-                                if(p[3] != 0x00) {
-                                    drawRect.setTop   (std::min<int>(fy, (int)drawRect.top()));
-                                    drawRect.setLeft  (std::min<int>(fx, (int)drawRect.left()));
-                                    drawRect.setBottom(std::max<int>(fy, (int)drawRect.bottom()));
-                                    drawRect.setRight (std::max<int>(fx, (int)drawRect.right()));
-                                }
+                    Rect drawRect(framePos + Point(m_size.width(), m_size.height()) * Otc::TILE_PIXELS - Point(1,1), framePos);
+                    for(int fx = framePos.x; fx < framePos.x + m_size.width() * Otc::TILE_PIXELS; ++fx) {
+                        for(int fy = framePos.y; fy < framePos.y + m_size.height() * Otc::TILE_PIXELS; ++fy) {
+                            uint8 *p = fullImage->getPixel(fx,fy);
+                            if(p[3] != 0x00) {
+                                drawRect.setTop   (std::min<int>(fy, (int)drawRect.top()));
+                                drawRect.setLeft  (std::min<int>(fx, (int)drawRect.left()));
+                                drawRect.setBottom(std::max<int>(fy, (int)drawRect.bottom()));
+                                drawRect.setRight (std::max<int>(fx, (int)drawRect.right()));
                             }
                         }
-
-                        m_texturesFramesRects[animationPhase][frameIndex] = drawRect;
-                        m_texturesFramesOriginRects[animationPhase][frameIndex] = Rect(framePos, Size(m_size.width(), m_size.height()) * Otc::TILE_PIXELS);
-                        m_texturesFramesOffsets[animationPhase][frameIndex] = drawRect.topLeft() - framePos;
                     }
+
+                    data->framesRects[frameIndex] = drawRect;
+                    data->framesOriginRects[frameIndex] = Rect(framePos, Size(m_size.width(), m_size.height()) * Otc::TILE_PIXELS);
+                    data->framesOffsets[frameIndex] = drawRect.topLeft() - framePos;
                 }
             }
         }
-        animationPhaseTexture = TexturePtr(new Texture(fullImage, true));
-        animationPhaseTexture->setSmooth(true);
     }
-    return animationPhaseTexture;
+
+    data->size = fullImage->getSize();
+    data->pixels.swap(fullImage->getPixels());
+    return data;
+}
+
+void ThingType::loadTexture(int animationPhase, const ThingTextureDataPtr& data)
+{
+    if(m_textures[animationPhase])
+        return;
+
+    ImagePtr fullImage(new Image(data->size));
+    fullImage->getPixels().swap(data->pixels);
+
+    m_texturesFramesRects[animationPhase] = std::move(data->framesRects);
+    m_texturesFramesOriginRects[animationPhase] = std::move(data->framesOriginRects);
+    m_texturesFramesOffsets[animationPhase] = std::move(data->framesOffsets);
+
+    // release cold textures before this one is accounted
+    TexturePtr texture = TexturePtr(new Texture(fullImage, true));
+    texture->setSmooth(true);
+    m_texturesUsage[animationPhase] = g_things.addTexture(this, animationPhase, getTextureMemory(texture));
+    m_textures[animationPhase] = texture;
+}
+
+void ThingType::unloadTexture(int animationPhase)
+{
+    TexturePtr& texture = m_textures[animationPhase];
+    if(!texture)
+        return;
+
+    // texture frames rects are kept, they are rebuilt along with the texture when it gets used again
+    g_things.removeTexture(m_texturesUsage[animationPhase], getTextureMemory(texture));
+    texture = nullptr;
+}
+
+void ThingType::unloadTextures()
+{
+    for(int i = 0; i < (int)m_textures.size(); ++i)
+        unloadTexture(i);
 }
 
 Size ThingType::getBestTextureDimension(int w, int h, int count)
@@ -568,7 +874,38 @@ int ThingType::getExactSize(int layer, int xPattern, int yPattern, int zPattern,
 void ThingType::setPathable(bool var)
 {
     if(var == true)
-        m_attribs.remove(ThingAttrNotPathable);
+        removeAttr(ThingAttrNotPathable);
     else
-        m_attribs.set(ThingAttrNotPathable, true);
+        setAttr(ThingAttrNotPathable);
+    g_things.invalidateThingTypeIndex();
+}
+
+int ThingType::attrValueIndex(int attr)
+{
+    switch(attr) {
+        case ThingAttrGround: return AttrValueGround;
+        case ThingAttrWritable: return AttrValueWritable;
+        case ThingAttrWritableOnce: return AttrValueWritableOnce;
+        case ThingAttrMinimapColor: return AttrValueMinimapColor;
+        case ThingAttrLensHelp: return AttrValueLensHelp;
+        case ThingAttrCloth: return AttrValueCloth;
+        case ThingAttrUsable: return AttrValueUsable;
+        default: return -1;
+    }
+}
+
+void ThingType::setAttrValue(int attr, uint16 value)
+{
+    int index = attrValueIndex(attr);
+    if(index >= 0)
+        m_attrValues[index] = value;
+    setAttr(attr);
+}
+
+uint16 ThingType::getAttrValue(int attr)
+{
+    int index = attrValueIndex(attr);
+    if(index < 0 || !hasAttr((ThingAttr)attr))
+        return 0;
+    return m_attrValues[index];
 }
@@ -120,23 +120,41 @@ struct Light {
     uint8 color;
 };
 
+// least recently used textures are at the back, each entry is a thing type animation phase
+typedef std::list<std::pair<ThingType*, int>> ThingTextureList;
+
+// pixels and frames of an animation phase texture, built by the async dispatcher and uploaded in the main thread
+struct ThingTextureData {
+    Size size;
+    std::vector<uint8> pixels;
+    std::vector<Rect> framesRects;
+    std::vector<Rect> framesOriginRects;
+    std::vector<Point> framesOffsets;
+    std::string error; // builds run in the async dispatcher, errors are logged by the main thread
+};
+typedef std::shared_ptr<ThingTextureData> ThingTextureDataPtr;
+
 class ThingType : public LuaObject
 {
 public:
     ThingType();
+    ~ThingType();
 
     void unserialize(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
     void unserializeOtml(const OTMLNodePtr& node);
 
     void serialize(const FileStreamPtr& fin);
+    void serializeSnapshot(const FileStreamPtr& fin);
+    void unserializeSnapshot(uint16 clientId, ThingCategory category, const FileStreamPtr& fin);
     void exportImage(std::string fileName);
 
     void draw(const Point& dest, float scaleFactor, int layer, int xPattern, int yPattern, int zPattern, int animationPhase, LightView *lightView = nullptr);
+    void drawOutfit(const Point& dest, float scaleFactor, int xPattern, int yPattern, int zPattern, int animationPhase, const Outfit& outfit, LightView *lightView = nullptr);
 
     uint16 getId() { return m_id; }
     ThingCategory getCategory() { return m_category; }
     bool isNull() { return m_null; }
-    bool hasAttr(ThingAttr attr) { return m_attribs.has(attr); }
+    bool hasAttr(ThingAttr attr) { return (m_flags & attrFlag(attr)) != 0; }
 
     Size getSize() { return m_size; }
     int getWidth() { return m_size.width(); }
@@ -149,67 +167,106 @@ public:
     int getNumPatternZ() { return m_numPatternZ; }
     int getAnimationPhases() { return m_animationPhases; }
     AnimatorPtr getAnimator() { return m_animator; }
+    Animator *rawGetAnimator() { return m_animator.get(); }
     Point getDisplacement() { return m_displacement; }
     int getDisplacementX() { return getDisplacement().x; }
     int getDisplacementY() { return getDisplacement().y; }
     int getElevation() { return m_elevation; }
 
-    int getGroundSpeed() { return m_attribs.get<uint16>(ThingAttrGround); }
-    int getMaxTextLength() { return m_attribs.has(ThingAttrWritableOnce) ? m_attribs.get<uint16>(ThingAttrWritableOnce) : m_attribs.get<uint16>(ThingAttrWritable); }
-    Light getLight() { return m_attribs.get<Light>(ThingAttrLight); }
-    int getMinimapColor() { return m_attribs.get<uint16>(ThingAttrMinimapColor); }
-    int getLensHelp() { return m_attribs.get<uint16>(ThingAttrLensHelp); }
-    int getClothSlot() { return m_attribs.get<uint16>(ThingAttrCloth); }
-    MarketData getMarketData() { return m_attribs.get<MarketData>(ThingAttrMarket); }
-    bool isGround() { return m_attribs.has(ThingAttrGround); }
-    bool isGroundBorder() { return m_attribs.has(ThingAttrGroundBorder); }
-    bool isOnBottom() { return m_attribs.has(ThingAttrOnBottom); }
-    bool isOnTop() { return m_attribs.has(ThingAttrOnTop); }
-    bool isContainer() { return m_attribs.has(ThingAttrContainer); }
-    bool isStackable() { return m_attribs.has(ThingAttrStackable); }
-    bool isForceUse() { return m_attribs.has(ThingAttrForceUse); }
-    bool isMultiUse() { return m_attribs.has(ThingAttrMultiUse); }
-    bool isWritable() { return m_attribs.has(ThingAttrWritable); }
-    bool isChargeable() { return m_attribs.has(ThingAttrChargeable); }
-    bool isWritableOnce() { return m_attribs.has(ThingAttrWritableOnce); }
-    bool isFluidContainer() { return m_attribs.has(ThingAttrFluidContainer); }
-    bool isSplash() { return m_attribs.has(ThingAttrSplash); }
-    bool isNotWalkable() { return m_attribs.has(ThingAttrNotWalkable); }
-    bool isNotMoveable() { return m_attribs.has(ThingAttrNotMoveable); }
-    bool blockProjectile() { return m_attribs.has(ThingAttrBlockProjectile); }
-    bool isNotPathable() { return m_attribs.has(ThingAttrNotPathable); }
-    bool isPickupable() { return m_attribs.has(ThingAttrPickupable); }
-    bool isHangable() { return m_attribs.has(ThingAttrHangable); }
-    bool isHookSouth() { return m_attribs.has(ThingAttrHookSouth); }
-    bool isHookEast() { return m_attribs.has(ThingAttrHookEast); }
-    bool isRotateable() { return m_attribs.has(ThingAttrRotateable); }
-    bool hasLight() { return m_attribs.has(ThingAttrLight); }
-    bool isDontHide() { return m_attribs.has(ThingAttrDontHide); }
-    bool isTranslucent() { return m_attribs.has(ThingAttrTranslucent); }
-    bool hasDisplacement() { return m_attribs.has(ThingAttrDisplacement); }
-    bool hasElevation() { return m_attribs.has(ThingAttrElevation); }
-    bool isLyingCorpse() { return m_attribs.has(ThingAttrLyingCorpse); }
-    bool isAnimateAlways() { return m_attribs.has(ThingAttrAnimateAlways); }
-    bool hasMiniMapColor() { return m_attribs.has(ThingAttrMinimapColor); }
-    bool hasLensHelp() { return m_attribs.has(ThingAttrLensHelp); }
-    bool isFullGround() { return m_attribs.has(ThingAttrFullGround); }
-    bool isIgnoreLook() { return m_attribs.has(ThingAttrLook); }
-    bool isCloth() { return m_attribs.has(ThingAttrCloth); }
-    bool isMarketable() { return m_attribs.has(ThingAttrMarket); }
-    bool isUsable() { return m_attribs.has(ThingAttrUsable); }
-    bool isWrapable() { return m_attribs.has(ThingAttrWrapable); }
-    bool isUnwrapable() { return m_attribs.has(ThingAttrUnwrapable); }
-    bool isTopEffect() { return m_attribs.has(ThingAttrTopEffect); }
+    int getGroundSpeed() { return m_attrValues[AttrValueGround]; }
+    int getMaxTextLength() { return isWritableOnce() ? m_attrValues[AttrValueWritableOnce] : m_attrValues[AttrValueWritable]; }
+    Light getLight() { return m_light; }
+    int getMinimapColor() { return m_attrValues[AttrValueMinimapColor]; }
+    int getLensHelp() { return m_attrValues[AttrValueLensHelp]; }
+    int getClothSlot() { return m_attrValues[AttrValueCloth]; }
+    MarketData getMarketData() { return m_marketData ? *m_marketData : MarketData(); }
+    bool isGround() { return hasAttr(ThingAttrGround); }
+    bool isGroundBorder() { return hasAttr(ThingAttrGroundBorder); }
+    bool isOnBottom() { return hasAttr(ThingAttrOnBottom); }
+    bool isOnTop() { return hasAttr(ThingAttrOnTop); }
+    bool isContainer() { return hasAttr(ThingAttrContainer); }
+    bool isStackable() { return hasAttr(ThingAttrStackable); }
+    bool isForceUse() { return hasAttr(ThingAttrForceUse); }
+    bool isMultiUse() { return hasAttr(ThingAttrMultiUse); }
+    bool isWritable() { return hasAttr(ThingAttrWritable); }
+    bool isChargeable() { return hasAttr(ThingAttrChargeable); }
+    bool isWritableOnce() { return hasAttr(ThingAttrWritableOnce); }
+    bool isFluidContainer() { return hasAttr(ThingAttrFluidContainer); }
+    bool isSplash() { return hasAttr(ThingAttrSplash); }
+    bool isNotWalkable() { return hasAttr(ThingAttrNotWalkable); }
+    bool isNotMoveable() { return hasAttr(ThingAttrNotMoveable); }
+    bool blockProjectile() { return hasAttr(ThingAttrBlockProjectile); }
+    bool isNotPathable() { return hasAttr(ThingAttrNotPathable); }
+    bool isPickupable() { return hasAttr(ThingAttrPickupable); }
+    bool isHangable() { return hasAttr(ThingAttrHangable); }
+    bool isHookSouth() { return hasAttr(ThingAttrHookSouth); }
+    bool isHookEast() { return hasAttr(ThingAttrHookEast); }
+    bool isRotateable() { return hasAttr(ThingAttrRotateable); }
+    bool hasLight() { return hasAttr(ThingAttrLight); }
+    bool isDontHide() { return hasAttr(ThingAttrDontHide); }
+    bool isTranslucent() { return hasAttr(ThingAttrTranslucent); }
+    bool hasDisplacement() { return hasAttr(ThingAttrDisplacement); }
+    bool hasElevation() { return hasAttr(ThingAttrElevation); }
+    bool isLyingCorpse() { return hasAttr(ThingAttrLyingCorpse); }
+    bool isAnimateAlways() { return hasAttr(ThingAttrAnimateAlways); }
+    bool hasMiniMapColor() { return hasAttr(ThingAttrMinimapColor); }
+    bool hasLensHelp() { return hasAttr(ThingAttrLensHelp); }
+    bool isFullGround() { return hasAttr(ThingAttrFullGround); }
+    bool isIgnoreLook() { return hasAttr(ThingAttrLook); }
+    bool isCloth() { return hasAttr(ThingAttrCloth); }
+    bool isMarketable() { return hasAttr(ThingAttrMarket); }
+    bool isUsable() { return hasAttr(ThingAttrUsable); }
+    bool isWrapable() { return hasAttr(ThingAttrWrapable); }
+    bool isUnwrapable() { return hasAttr(ThingAttrUnwrapable); }
+    bool isTopEffect() { return hasAttr(ThingAttrTopEffect); }
 
     std::vector<int> getSprites() { return m_spritesIndex; }
 
     // additional
     float getOpacity() { return m_opacity; }
-    bool isNotPreWalkable() { return m_attribs.has(ThingAttrNotPreWalkable); }
+    bool isNotPreWalkable() { return hasAttr(ThingAttrNotPreWalkable); }
     void setPathable(bool var);
 
+    void prefetchTextures();
+    ThingTextureDataPtr buildTexture(int animationPhase);
+    void loadTexture(int animationPhase, const ThingTextureDataPtr& data);
+    void unloadTexture(int animationPhase);
+    void unloadTextures();
+    bool isTextureLoaded(int animationPhase) { return m_textures[animationPhase] != nullptr; }
+
 private:
-    const TexturePtr& getTexture(int animationPhase);
+    // values of the attributes that carry a 16 bit value
+    enum AttrValue {
+        AttrValueGround = 0,
+        AttrValueWritable,
+        AttrValueWritableOnce,
+        AttrValueMinimapColor,
+        AttrValueLensHelp,
+        AttrValueCloth,
+        AttrValueUsable,
+        AttrValueLast
+    };
+
+    // every known attribute has its own bit, the ones above 47 are folded into the free high bits
+    static uint64 attrFlag(int attr) {
+        if(attr < 48)
+            return (uint64)1 << attr;
+        if(attr == ThingAttrOpacity || attr == ThingAttrNotPreWalkable)
+            return (uint64)1 << (attr - ThingAttrOpacity + 48);
+        if(attr >= ThingAttrFloorChange && attr < ThingLastAttr)
+            return (uint64)1 << (attr - ThingAttrFloorChange + 56);
+        return 0;
+    }
+    static int attrValueIndex(int attr);
+
+    void setAttr(int attr) { m_flags |= attrFlag(attr); }
+    void removeAttr(int attr) { m_flags &= ~attrFlag(attr); }
+    void setAttrValue(int attr, uint16 value);
+    uint16 getAttrValue(int attr);
+
+    const TexturePtr& getTexture(int animationPhase, bool async = false);
+    int getPlaceholderPhase(int animationPhase);
+    static int64 getTextureMemory(const TexturePtr& texture) { return texture->getGlSize().area() * 4; }
     Size getBestTextureDimension(int w, int h, int count);
     uint getSpriteIndex(int w, int h, int l, int x, int y, int z, int a);
     uint getTextureIndex(int l, int x, int y, int z);
@@ -217,7 +274,10 @@ private:
     ThingCategory m_category;
     uint16 m_id;
     bool m_null;
-    stdext::dynamic_storage<uint8> m_attribs;
+    uint64 m_flags;
+    uint16 m_attrValues[AttrValueLast];
+    Light m_light;
+    std::unique_ptr<MarketData> m_marketData;
 
     Size m_size;
     Point m_displacement;
@@ -233,6 +293,7 @@ private:
 
     std::vector<int> m_spritesIndex;
     std::vector<TexturePtr> m_textures;
+    std::vector<ThingTextureList::iterator> m_texturesUsage;
     std::vector<std::vector<Rect>> m_texturesFramesRects;
     std::vector<std::vector<Rect>> m_texturesFramesOriginRects;
     std::vector<std::vector<Point>> m_texturesFramesOffsets;
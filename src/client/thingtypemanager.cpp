@@ -28,8 +28,12 @@
 #include "creature.h"
 #include "creatures.h"
 #include "game.h"
+#include "outfitcache.h"
 
 #include <framework/core/resourcemanager.h>
+#include <framework/core/asyncdispatcher.h>
+#include <framework/core/clock.h>
+#include <framework/core/application.h>
 #include <framework/core/filestream.h>
 #include <framework/core/binarytree.h>
 #include <framework/xml/tinyxml.h>
@@ -37,8 +41,21 @@
 
 ThingTypeManager g_things;
 
+static uint8 getSnapshotFeatures()
+{
+    // features that change how the dat is parsed
+    return (g_game.getFeature(Otc::GameSpritesU32) ? 1 : 0) |
+           (g_game.getFeature(Otc::GameEnhancedAnimations) ? 2 : 0) |
+           (g_game.getFeature(Otc::GameIdleAnimations) ? 4 : 0);
+}
+
 void ThingTypeManager::init()
 {
+    m_textureMemoryBudget = TEXTURE_MEMORY_BUDGET;
+    m_textureMemoryUsage = 0;
+    m_textureMemoryPeak = 0;
+    m_releasedTextures = 0;
+    m_textureUploadFrame = 0;
     m_nullThingType = ThingTypePtr(new ThingType);
     m_nullItemType = ItemTypePtr(new ItemType);
     m_datSignature = 0;
@@ -48,6 +65,10 @@ void ThingTypeManager::init()
     m_datLoaded = false;
     m_xmlLoaded = false;
     m_otbLoaded = false;
+    m_datLoadTime = 0;
+    m_otbLoadTime = 0;
+    m_xmlLoadTime = 0;
+    m_otbHash = 0;
     for(auto &m_thingType: m_thingTypes)
         m_thingType.resize(1, m_nullThingType);
     m_itemTypes.resize(1, m_nullItemType);
@@ -55,14 +76,128 @@ void ThingTypeManager::init()
 
 void ThingTypeManager::terminate()
 {
+    cancelTextures();
     for(auto &m_thingType: m_thingTypes)
         m_thingType.clear();
     m_itemTypes.clear();
     m_reverseItemTypes.clear();
+    m_itemIndexDirty = true;
+    for(ItemTypeList& itemTypes : m_itemCategories)
+        itemTypes.clear();
+    m_thingAttrIndex.clear();
     m_nullThingType = nullptr;
     m_nullItemType = nullptr;
 }
 
+ThingTextureList::iterator ThingTypeManager::addTexture(ThingType* thingType, int animationPhase, int64 memory)
+{
+    releaseTextures(memory);
+
+    m_textureMemoryUsage += memory;
+    m_textureMemoryPeak = std::max<int64>(m_textureMemoryPeak, m_textureMemoryUsage);
+    m_textures.emplace_front(thingType, animationPhase);
+    return m_textures.begin();
+}
+
+void ThingTypeManager::removeTexture(ThingTextureList::iterator it, int64 memory)
+{
+    m_textureMemoryUsage -= memory;
+    m_textures.erase(it);
+}
+
+void ThingTypeManager::setTextureMemoryBudget(int64 budget)
+{
+    m_textureMemoryBudget = std::max<int64>(budget, 0);
+    releaseTextures(0);
+}
+
+void ThingTypeManager::releaseTextures(int64 neededMemory)
+{
+    if(m_textureMemoryBudget == 0)
+        return;
+
+    while(!m_textures.empty() && m_textureMemoryUsage + neededMemory > m_textureMemoryBudget) {
+        // unloadTexture removes the entry from the list
+        auto coldest = m_textures.back();
+        coldest.first->unloadTexture(coldest.second);
+        m_releasedTextures++;
+    }
+}
+
+void ThingTypeManager::requestTexture(ThingType* thingType, int animationPhase)
+{
+    uploadTextures();
+
+    auto key = std::make_pair(thingType, animationPhase);
+    if(thingType->isTextureLoaded(animationPhase) || m_textureBuilds.find(key) != m_textureBuilds.end())
+        return;
+
+    // the thing type is referenced until its texture is uploaded, so it's never destroyed while being built
+    TextureBuild& build = m_textureBuilds[key];
+    build.thingType = thingType->static_self_cast<ThingType>();
+    build.data = g_asyncDispatcher.schedule([thingType, animationPhase]() -> ThingTextureDataPtr {
+        try {
+            return thingType->buildTexture(animationPhase);
+        } catch(stdext::exception& e) {
+            ThingTextureDataPtr data = std::make_shared<ThingTextureData>();
+            data->error = stdext::format("Failed to build thing type texture: %s", e.what());
+            return data;
+        }
+    });
+}
+
+ThingTextureDataPtr ThingTypeManager::waitTexture(ThingType* thingType, int animationPhase)
+{
+    auto it = m_textureBuilds.find(std::make_pair(thingType, animationPhase));
+    if(it == m_textureBuilds.end())
+        return nullptr;
+
+    ThingTextureDataPtr data = it->second.data.get();
+    m_textureBuilds.erase(it);
+    if(!data->error.empty())
+        g_logger.error(data->error);
+    return data->pixels.empty() ? nullptr : data;
+}
+
+void ThingTypeManager::cancelTextures()
+{
+    for(auto& it : m_textureBuilds)
+        it.second.data.wait();
+    m_textureBuilds.clear();
+}
+
+void ThingTypeManager::uploadTextures()
+{
+    if(m_textureBuilds.empty() || m_textureUploadFrame == g_clock.micros())
+        return;
+    m_textureUploadFrame = g_clock.micros();
+
+    // at least one texture is uploaded per frame
+    ticks_t startTime = stdext::micros();
+    for(auto it = m_textureBuilds.begin(); it != m_textureBuilds.end();) {
+        if(!it->second.data.is_ready()) {
+            ++it;
+            continue;
+        }
+
+        ThingTypePtr thingType = it->second.thingType;
+        int animationPhase = it->first.second;
+        ThingTextureDataPtr data = it->second.data.get();
+        it = m_textureBuilds.erase(it);
+
+        // a failed build is requested again when the thing is drawn
+        if(!data->error.empty())
+            g_logger.error(data->error);
+        if(!data->pixels.empty()) {
+            thingType->loadTexture(animationPhase, data);
+            g_app.repaint();
+        }
+
+        if(stdext::micros() - startTime >= TEXTURE_UPLOAD_BUDGET)
+            break;
+    }
+}
+
 void ThingTypeManager::saveDat(std::string fileName)
 {
     if(!m_datLoaded)
@@ -97,21 +232,63 @@ void ThingTypeManager::saveDat(std::string fileName)
     }
 }
 
-bool ThingTypeManager::loadDat(std::string file)
+std::string ThingTypeManager::getSnapshotFile(SnapshotKind kind, uint32 hash)
 {
-    m_datLoaded = false;
-    m_datSignature = 0;
-    m_contentRevision = 0;
-    try {
-        file = g_resources.guessFilePath(file, "dat");
+    static const char *kindNames[] = { "dat", "otb", "xml" };
+    return stdext::format("/snapshots/%s-%08x.snap", kindNames[kind], hash);
+}
+
+FileStreamPtr ThingTypeManager::openSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash)
+{
+    std::string file = getSnapshotFile(kind, hash);
+    if(!m_snapshotsEnabled || !g_resources.fileExists(file))
+        return nullptr;
+
+    // snapshots are read with a single read, records are then decoded from memory
+    FileStreamPtr fin = g_resources.openFile(file);
+    fin->cache();
+
+    if(fin->getU32() != SNAPSHOT_MAGIC || fin->getU16() != SNAPSHOT_VERSION || fin->getU8() != kind ||
+       fin->getU32() != hash || fin->getU32() != size || fin->getU32() != parentHash ||
+       fin->getU16() != g_game.getClientVersion() || fin->getU8() != getSnapshotFeatures()) {
+        g_logger.debug(stdext::format("ignoring outdated snapshot '%s'", file));
+        return nullptr;
+    }
+    return fin;
+}
 
-        FileStreamPtr fin = g_resources.openFile(file);
+FileStreamPtr ThingTypeManager::createSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash)
+{
+    g_resources.makeDir("snapshots");
+
+    FileStreamPtr fin = g_resources.createFile(getSnapshotFile(kind, hash));
+    fin->cache();
+
+    fin->addU32(SNAPSHOT_MAGIC);
+    fin->addU16(SNAPSHOT_VERSION);
+    fin->addU8(kind);
+    fin->addU32(hash);
+    fin->addU32(size);
+    fin->addU32(parentHash);
+    fin->addU16(g_game.getClientVersion());
+    fin->addU8(getSnapshotFeatures());
+    return fin;
+}
+
+bool ThingTypeManager::loadDatSnapshot(uint32 hash, uint32 size)
+{
+    try {
+        FileStreamPtr fin = openSnapshot(SnapshotDat, hash, size, 0);
+        if(!fin)
+            return false;
 
         m_datSignature = fin->getU32();
         m_contentRevision = static_cast<uint16_t>(m_datSignature);
 
         for(auto &m_thingType: m_thingTypes) {
             int count = fin->getU16() + 1;
+            if(count - 1 > (int)(fin->size() - fin->tell()))
+                stdext::throw_exception("snapshot is truncated");
             m_thingType.clear();
             m_thingType.resize(count, m_nullThingType);
         }
@@ -122,12 +299,166 @@ bool ThingTypeManager::loadDat(std::string file)
                 firstId = 100;
             for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
                 ThingTypePtr type(new ThingType);
-                type->unserialize(id, (ThingCategory)category, fin);
+                type->unserializeSnapshot(id, (ThingCategory)category, fin);
                 m_thingTypes[category][id] = type;
             }
         }
+        return true;
+    } catch(std::exception& e) {
+        g_logger.warning(stdext::format("Failed to read dat snapshot: %s", e.what()));
+        return false;
+    }
+}
+
+void ThingTypeManager::saveDatSnapshot(uint32 hash, uint32 size)
+{
+    if(!m_snapshotsEnabled)
+        return;
+
+    try {
+        FileStreamPtr fin = createSnapshot(SnapshotDat, hash, size, 0);
+
+        fin->addU32(m_datSignature);
+        for(auto &m_thingType: m_thingTypes)
+            fin->addU16(m_thingType.size() - 1);
+
+        for(int category = 0; category < ThingLastCategory; ++category) {
+            uint16 firstId = 1;
+            if(category == ThingCategoryItem)
+                firstId = 100;
+            for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id)
+                m_thingTypes[category][id]->serializeSnapshot(fin);
+        }
+
+        fin->flush();
+        fin->close();
+    } catch(std::exception& e) {
+        g_logger.warning(stdext::format("Failed to save dat snapshot: %s", e.what()));
+    }
+}
+
+bool ThingTypeManager::loadItemsSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash)
+{
+    try {
+        FileStreamPtr fin = openSnapshot(kind, hash, size, parentHash);
+        if(!fin)
+            return false;
+
+        uint32 otbMajorVersion = fin->getU32();
+        uint32 otbMinorVersion = fin->getU32();
+
+        // counts are bounded by the bytes left before allocating, each entry takes at least one byte
+        uint32 count = fin->getU32();
+        if(count > fin->size() - fin->tell())
+            stdext::throw_exception("snapshot is truncated");
+        ItemTypeList itemTypes(count, m_nullItemType);
+        for(ItemTypePtr& itemType : itemTypes) {
+            if(!fin->getU8())
+                continue;
+            itemType = ItemTypePtr(new ItemType);
+            itemType->unserializeSnapshot(fin);
+        }
+
+        // reverse entries are stored by server id and point to the same item types
+        count = fin->getU32();
+        if(count > (fin->size() - fin->tell()) / 2)
+            stdext::throw_exception("snapshot is truncated");
+        ItemTypeList reverseItemTypes(count, m_nullItemType);
+        for(ItemTypePtr& itemType : reverseItemTypes) {
+            uint16 serverId = fin->getU16();
+            if(serverId < itemTypes.size())
+                itemType = itemTypes[serverId];
+        }
+
+        m_otbMajorVersion = otbMajorVersion;
+        m_otbMinorVersion = otbMinorVersion;
+        m_itemTypes.swap(itemTypes);
+        m_reverseItemTypes.swap(reverseItemTypes);
+        m_itemIndexDirty = true;
+        return true;
+    } catch(std::exception& e) {
+        g_logger.warning(stdext::format("Failed to read items snapshot: %s", e.what()));
+        return false;
+    }
+}
+
+void ThingTypeManager::saveItemsSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash)
+{
+    if(!m_snapshotsEnabled)
+        return;
+
+    try {
+        FileStreamPtr fin = createSnapshot(kind, hash, size, parentHash);
+
+        fin->addU32(m_otbMajorVersion);
+        fin->addU32(m_otbMinorVersion);
+
+        fin->addU32(m_itemTypes.size());
+        for(const ItemTypePtr& itemType : m_itemTypes) {
+            bool null = itemType == m_nullItemType;
+            fin->addU8(null ? 0 : 1);
+            if(!null)
+                itemType->serializeSnapshot(fin);
+        }
+
+        fin->addU32(m_reverseItemTypes.size());
+        for(const ItemTypePtr& itemType : m_reverseItemTypes)
+            fin->addU16(itemType ? itemType->getServerId() : 0);
+
+        fin->flush();
+        fin->close();
+    } catch(std::exception& e) {
+        g_logger.warning(stdext::format("Failed to save items snapshot: %s", e.what()));
+    }
+}
+
+bool ThingTypeManager::loadDat(std::string file)
+{
+    m_datLoaded = false;
+    m_datFromSnapshot = false;
+    m_thingAttrIndex.clear();
+    m_datSignature = 0;
+    m_contentRevision = 0;
+    cancelTextures();
+    g_outfitCache.clear();
+    ticks_t startTime = stdext::millis();
+    try {
+        file = g_resources.guessFilePath(file, "dat");
+
+        // the dat is read at once, its hash identifies the snapshot made from it
+        std::string buffer = g_resources.readFileContents(file);
+        uint32 hash = stdext::adler32((const uint8*)buffer.data(), buffer.size());
+
+        m_datFromSnapshot = loadDatSnapshot(hash, buffer.size());
+        if(!m_datFromSnapshot) {
+            FileStreamPtr fin(new FileStream(file, buffer));
+
+            m_datSignature = fin->getU32();
+            m_contentRevision = static_cast<uint16_t>(m_datSignature);
+
+            for(auto &m_thingType: m_thingTypes) {
+                int count = fin->getU16() + 1;
+                m_thingType.clear();
+                m_thingType.resize(count, m_nullThingType);
+            }
+
+            for(int category = 0; category < ThingLastCategory; ++category) {
+                uint16 firstId = 1;
+                if(category == ThingCategoryItem)
+                    firstId = 100;
+                for(uint16 id = firstId; id < m_thingTypes[category].size(); ++id) {
+                    ThingTypePtr type(new ThingType);
+                    type->unserialize(id, (ThingCategory)category, fin);
+                    m_thingTypes[category][id] = type;
+                }
+            }
+
+            saveDatSnapshot(hash, buffer.size());
+        }
 
         m_datLoaded = true;
+        m_datLoadTime = stdext::millis() - startTime;
+        g_logger.info(stdext::format("Loaded dat '%s' in %dms%s", file, (int)m_datLoadTime, m_datFromSnapshot ? " (snapshot)" : ""));
         g_lua.callGlobalField("g_things", "onLoadDat", file);
         return true;
     } catch(stdext::exception& e) {
@@ -138,6 +469,7 @@ bool ThingTypeManager::loadDat(std::string file)
 
 bool ThingTypeManager::loadOtml(std::string file)
 {
+    m_thingAttrIndex.clear();
     try {
         file = g_resources.guessFilePath(file, "otml");
 
@@ -173,49 +505,62 @@ bool ThingTypeManager::loadOtml(std::string file)
 
 void ThingTypeManager::loadOtb(const std::string& file)
 {
+    m_otbFromSnapshot = false;
+    ticks_t startTime = stdext::millis();
     try {
-        FileStreamPtr fin = g_resources.openFile(file);
-
-        uint signature = fin->getU32();
-        if(signature != 0)
-            stdext::throw_exception("invalid otb file");
-
-        BinaryTreePtr root = fin->getBinaryTree();
-        root->skip(1); // otb first byte is always 0
-
-        signature = root->getU32();
-        if(signature != 0)
-            stdext::throw_exception("invalid otb file");
+        std::string buffer = g_resources.readFileContents(file);
+        uint32 hash = stdext::adler32((const uint8*)buffer.data(), buffer.size());
+
+        m_otbFromSnapshot = loadItemsSnapshot(SnapshotOtb, hash, buffer.size(), 0);
+        if(!m_otbFromSnapshot) {
+            FileStreamPtr fin(new FileStream(file, buffer));
+
+            uint signature = fin->getU32();
+            if(signature != 0)
+                stdext::throw_exception("invalid otb file");
+
+            BinaryTreePtr root = fin->getBinaryTree();
+            root->skip(1); // otb first byte is always 0
+
+            signature = root->getU32();
+            if(signature != 0)
+                stdext::throw_exception("invalid otb file");
+
+            uint8 rootAttr = root->getU8();
+            if(rootAttr == 0x01) { // OTB_ROOT_ATTR_VERSION
+                uint16 size = root->getU16();
+                if(size != 4 + 4 + 4 + 128)
+                    stdext::throw_exception("invalid otb root attr version size");
+
+                m_otbMajorVersion = root->getU32();
+                m_otbMinorVersion = root->getU32();
+                root->skip(4); // buildNumber
+                root->skip(128); // description
+            }
 
-        uint8 rootAttr = root->getU8();
-        if(rootAttr == 0x01) { // OTB_ROOT_ATTR_VERSION
-            uint16 size = root->getU16();
-            if(size != 4 + 4 + 4 + 128)
-                stdext::throw_exception("invalid otb root attr version size");
+            BinaryTreeVec children = root->getChildren();
+            m_reverseItemTypes.clear();
+            m_itemTypes.resize(children.size() + 1, m_nullItemType);
+            m_reverseItemTypes.resize(children.size() + 1, m_nullItemType);
 
-            m_otbMajorVersion = root->getU32();
-            m_otbMinorVersion = root->getU32();
-            root->skip(4); // buildNumber
-            root->skip(128); // description
-        }
+            for(const BinaryTreePtr& node : children) {
+                ItemTypePtr itemType(new ItemType);
+                itemType->unserialize(node);
+                addItemType(itemType);
 
-        BinaryTreeVec children = root->getChildren();
-        m_reverseItemTypes.clear();
-        m_itemTypes.resize(children.size() + 1, m_nullItemType);
-        m_reverseItemTypes.resize(children.size() + 1, m_nullItemType);
-
-        for(const BinaryTreePtr& node : children) {
-            ItemTypePtr itemType(new ItemType);
-            itemType->unserialize(node);
-            addItemType(itemType);
+                uint16 clientId = itemType->getClientId();
+                if(unlikely(clientId >= m_reverseItemTypes.size()))
+                    m_reverseItemTypes.resize(clientId + 1);
+                m_reverseItemTypes[clientId] = itemType;
+            }
 
-            uint16 clientId = itemType->getClientId();
-            if(unlikely(clientId >= m_reverseItemTypes.size()))
-                m_reverseItemTypes.resize(clientId + 1);
-            m_reverseItemTypes[clientId] = itemType;
+            saveItemsSnapshot(SnapshotOtb, hash, buffer.size(), 0);
         }
 
+        m_otbHash = hash;
         m_otbLoaded = true;
+        m_otbLoadTime = stdext::millis() - startTime;
+        g_logger.info(stdext::format("Loaded otb '%s' in %dms%s", file, (int)m_otbLoadTime, m_otbFromSnapshot ? " (snapshot)" : ""));
         g_lua.callGlobalField("g_things", "onLoadOtb", file);
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (OTB file): %s", file, e.what()));
@@ -224,12 +569,25 @@ void ThingTypeManager::loadOtb(const std::string& file)
 
 void ThingTypeManager::loadXml(const std::string& file)
 {
+    m_xmlFromSnapshot = false;
+    ticks_t startTime = stdext::millis();
     try {
         if(!isOtbLoaded())
             stdext::throw_exception("OTB must be loaded before XML");
 
+        // the xml snapshot holds the whole item table, so it also depends on the loaded otb
+        std::string buffer = g_resources.readFileContents(file);
+        uint32 hash = stdext::adler32((const uint8*)buffer.data(), buffer.size());
+        if(loadItemsSnapshot(SnapshotXml, hash, buffer.size(), m_otbHash)) {
+            m_xmlFromSnapshot = true;
+            m_xmlLoaded = true;
+            m_xmlLoadTime = stdext::millis() - startTime;
+            g_logger.info(stdext::format("Loaded xml '%s' in %dms (snapshot)", file, (int)m_xmlLoadTime));
+            return;
+        }
+
         TiXmlDocument doc;
-        doc.Parse(g_resources.readFileContents(file).c_str());
+        doc.Parse(buffer.c_str());
         if(doc.Error())
             stdext::throw_exception(stdext::format("failed to parse '%s': '%s'", file, doc.ErrorDesc()));
 
@@ -266,8 +624,11 @@ void ThingTypeManager::loadXml(const std::string& file)
         }
 
         doc.Clear();
+        saveItemsSnapshot(SnapshotXml, hash, buffer.size(), m_otbHash);
+
         m_xmlLoaded = true;
-        g_logger.debug("items.xml read successfully.");
+        m_xmlLoadTime = stdext::millis() - startTime;
+        g_logger.info(stdext::format("Loaded xml '%s' in %dms", file, (int)m_xmlLoadTime));
     } catch(std::exception& e) {
         g_logger.error(stdext::format("Failed to load '%s' (XML file): %s", file, e.what()));
     }
@@ -275,6 +636,9 @@ void ThingTypeManager::loadXml(const std::string& file)
 
 void ThingTypeManager::parseItemType(uint16 serverId, TiXmlElement* elem)
 {
+    // names, descriptions and categories come from the xml
+    m_itemIndexDirty = true;
+
     ItemTypePtr itemType = nullptr;
 
     bool s;
@@ -335,6 +699,7 @@ void ThingTypeManager::addItemType(const ItemTypePtr& itemType)
     if(unlikely(id >= m_itemTypes.size()))
         m_itemTypes.resize(id + 1, m_nullItemType);
     m_itemTypes[id] = itemType;
+    m_itemIndexDirty = true;
 }
 
 const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
@@ -348,29 +713,182 @@ const ItemTypePtr& ThingTypeManager::findItemTypeByClientId(uint16 id)
         return m_nullItemType;
 }
 
+static uint32 getTrigram(const std::string& text, size_t pos)
+{
+    return (uint8)text[pos] << 16 | (uint8)text[pos + 1] << 8 | (uint8)text[pos + 2];
+}
+
+void ThingTypeManager::buildItemIndex()
+{
+    m_itemNames.clear();
+    m_itemNameIds.clear();
+    m_itemNameIndex.clear();
+    m_itemTrigrams.clear();
+    for(ItemTypeList& itemTypes : m_itemCategories)
+        itemTypes.clear();
+
+    for(uint16 id = 0; id < m_itemTypes.size(); ++id) {
+        const ItemTypePtr& itemType = m_itemTypes[id];
+        if(itemType->getCategory() < ItemCategoryLast)
+            m_itemCategories[itemType->getCategory()].push_back(itemType);
+
+        std::string name = itemType->getName();
+        if(name.empty())
+            continue;
+
+        stdext::tolower(name);
+        auto it = m_itemNameIndex.find(name);
+        if(it != m_itemNameIndex.end()) {
+            m_itemNameIds[it->second].push_back(id);
+            continue;
+        }
+
+        int index = m_itemNames.size();
+        m_itemNameIndex[name] = index;
+        m_itemNameIds.push_back({id});
+
+        // names are added in order, so each trigram list is sorted and a name is added to it once
+        for(size_t pos = 0; pos + 3 <= name.size(); ++pos) {
+            std::vector<int>& names = m_itemTrigrams[getTrigram(name, pos)];
+            if(names.empty() || names.back() != index)
+                names.push_back(index);
+        }
+        m_itemNames.push_back(std::move(name));
+    }
+
+    m_itemIndexDirty = false;
+}
+
+std::vector<int> ThingTypeManager::findItemNames(const std::string& text)
+{
+    if(m_itemIndexDirty)
+        buildItemIndex();
+
+    std::vector<int> ret;
+    if(text.size() < 3) {
+        for(uint i = 0; i < m_itemNames.size(); ++i) {
+            if(m_itemNames[i].find(text) != std::string::npos)
+                ret.push_back(i);
+        }
+        return ret;
+    }
+
+    // every match contains all the text trigrams, so only the names of the rarest one are checked
+    const std::vector<int> *candidates = nullptr;
+    for(size_t pos = 0; pos + 3 <= text.size(); ++pos) {
+        auto it = m_itemTrigrams.find(getTrigram(text, pos));
+        if(it == m_itemTrigrams.end())
+            return ret;
+        if(!candidates || it->second.size() < candidates->size())
+            candidates = &it->second;
+    }
+
+    for(int index : *candidates) {
+        if(m_itemNames[index].find(text) != std::string::npos)
+            ret.push_back(index);
+    }
+    return ret;
+}
+
 const ItemTypePtr& ThingTypeManager::findItemTypeByName(std::string name)
 {
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            return it;
+    if(m_itemIndexDirty)
+        buildItemIndex();
+
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+    auto it = m_itemNameIndex.find(lowerName);
+    if(it != m_itemNameIndex.end()) {
+        for(uint16 id : m_itemNameIds[it->second]) {
+            if(m_itemTypes[id]->getName() == name)
+                return m_itemTypes[id];
+        }
+    }
     return m_nullItemType;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByName(std::string name)
 {
+    if(m_itemIndexDirty)
+        buildItemIndex();
+
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName() == name)
-            ret.push_back(it);
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+    auto it = m_itemNameIndex.find(lowerName);
+    if(it != m_itemNameIndex.end()) {
+        for(uint16 id : m_itemNameIds[it->second]) {
+            if(m_itemTypes[id]->getName() == name)
+                ret.push_back(m_itemTypes[id]);
+        }
+    }
     return ret;
 }
 
 ItemTypeList ThingTypeManager::findItemTypesByString(std::string name)
 {
+    if(name.empty())
+        return m_itemTypes;
+
+    std::string lowerName = name;
+    stdext::tolower(lowerName);
+    std::vector<uint16> ids;
+    for(int index : findItemNames(lowerName)) {
+        for(uint16 id : m_itemNameIds[index]) {
+            if(m_itemTypes[id]->getName().find(name) != std::string::npos)
+                ids.push_back(id);
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+
     ItemTypeList ret;
-    for(const ItemTypePtr& it : m_itemTypes)
-        if(it->getName().find(name) != std::string::npos)
-            ret.push_back(it);
+    for(uint16 id : ids)
+        ret.push_back(m_itemTypes[id]);
+    return ret;
+}
+
+ItemTypeList ThingTypeManager::searchItemTypes(std::string text, int maxResults)
+{
+    stdext::tolower(text);
+    stdext::trim(text);
+    if(text.empty())
+        return ItemTypeList();
+
+    enum { RankExact, RankPrefix, RankWord, RankSubstring };
+
+    std::vector<std::pair<int, int>> matches;
+    for(int index : findItemNames(text)) {
+        const std::string& name = m_itemNames[index];
+        int rank;
+        if(name.size() == text.size())
+            rank = RankExact;
+        else if(stdext::starts_with(name, text))
+            rank = RankPrefix;
+        else if(name.find(" " + text) != std::string::npos)
+            rank = RankWord;
+        else
+            rank = RankSubstring;
+        matches.emplace_back(rank, index);
+    }
+
+    std::sort(matches.begin(), matches.end(), [&](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+        if(a.first != b.first)
+            return a.first < b.first;
+        const std::string& aName = m_itemNames[a.second];
+        const std::string& bName = m_itemNames[b.second];
+        if(aName.size() != bName.size())
+            return aName.size() < bName.size();
+        return aName < bName;
+    });
+
+    ItemTypeList ret;
+    for(const auto& match : matches) {
+        for(uint16 id : m_itemNameIds[match.second]) {
+            if(maxResults > 0 && (int)ret.size() >= maxResults)
+                return ret;
+            ret.push_back(m_itemTypes[id]);
+        }
+    }
     return ret;
 }
 
@@ -394,7 +912,16 @@ const ItemTypePtr& ThingTypeManager::getItemType(uint16 id)
 
 ThingTypeList ThingTypeManager::findThingTypeByAttr(ThingAttr attr, ThingCategory category)
 {
-    ThingTypeList ret;
+    if(category >= ThingLastCategory)
+        return ThingTypeList();
+
+    // each attribute list is built by its first lookup after the thing types change
+    auto key = std::make_pair((int)category, (int)attr);
+    auto it = m_thingAttrIndex.find(key);
+    if(it != m_thingAttrIndex.end())
+        return it->second;
+
+    ThingTypeList& ret = m_thingAttrIndex[key];
     for(const ThingTypePtr& type : m_thingTypes[category])
         if(type->hasAttr(attr))
             ret.push_back(type);
@@ -403,11 +930,12 @@ ThingTypeList ThingTypeManager::findThingTypeByAttr(ThingAttr attr, ThingCategor
 
 ItemTypeList ThingTypeManager::findItemTypeByCategory(ItemCategory category)
 {
-    ItemTypeList ret;
-    for(const ItemTypePtr& type : m_itemTypes)
-        if(type->getCategory() == category)
-            ret.push_back(type);
-    return ret;
+    if(category >= ItemCategoryLast)
+        return ItemTypeList();
+
+    if(m_itemIndexDirty)
+        buildItemIndex();
+    return m_itemCategories[category];
 }
 
 const ThingTypeList& ThingTypeManager::getThingTypes(ThingCategory category)
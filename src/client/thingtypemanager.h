@@ -25,12 +25,34 @@
 
 #include <framework/global.h>
 #include <framework/core/declarations.h>
+#include <framework/stdext/thread.h>
 
 #include "thingtype.h"
 #include "itemtype.h"
 
 class ThingTypeManager
 {
+    enum {
+        TEXTURE_MEMORY_BUDGET = 256 * 1024 * 1024,
+        TEXTURE_UPLOAD_BUDGET = 2000
+    };
+
+    enum SnapshotKind : uint8 {
+        SnapshotDat = 0,
+        SnapshotOtb,
+        SnapshotXml
+    };
+
+    enum {
+        SNAPSHOT_MAGIC = 0x50534E53, // "SNSP"
+        SNAPSHOT_VERSION = 2
+    };
+
+    struct TextureBuild {
+        ThingTypePtr thingType;
+        boost::shared_future<ThingTextureDataPtr> data;
+    };
+
 public:
     void init();
     void terminate();
@@ -49,6 +71,10 @@ public:
     ItemTypeList findItemTypesByName(std::string name);
     ItemTypeList findItemTypesByString(std::string name);
 
+    /// Case insensitive search of item names, exact names come first, then names starting with the text,
+    /// then names with a word starting with it and then any other match, maxResults 0 means no limit
+    ItemTypeList searchItemTypes(std::string text, int maxResults);
+
     const ThingTypePtr& getNullThingType() { return m_nullThingType; }
     const ItemTypePtr& getNullItemType() { return m_nullItemType; }
 
@@ -72,14 +98,79 @@ public:
     bool isXmlLoaded() { return m_xmlLoaded; }
     bool isOtbLoaded() { return m_otbLoaded; }
 
+    /// Parsed dat, otb and xml tables are saved to the write directory as binary snapshots,
+    /// later loads of the same files read the snapshot instead of parsing them again
+    void setSnapshotsEnabled(bool enable) { m_snapshotsEnabled = enable; }
+    bool isSnapshotsEnabled() { return m_snapshotsEnabled; }
+    ticks_t getDatLoadTime() { return m_datLoadTime; }
+    ticks_t getOtbLoadTime() { return m_otbLoadTime; }
+    ticks_t getXmlLoadTime() { return m_xmlLoadTime; }
+    bool isDatFromSnapshot() { return m_datFromSnapshot; }
+    bool isOtbFromSnapshot() { return m_otbFromSnapshot; }
+    bool isXmlFromSnapshot() { return m_xmlFromSnapshot; }
+
+    ThingTextureList::iterator addTexture(ThingType* thingType, int animationPhase, int64 memory);
+    void removeTexture(ThingTextureList::iterator it, int64 memory);
+    void touchTexture(ThingTextureList::iterator it) { m_textures.splice(m_textures.begin(), m_textures, it); }
+
+    /// Memory in bytes that thing type textures may use before the least recently used ones are released,
+    /// released textures are rebuilt from the sprites when they are drawn again, 0 disables the limit
+    void setTextureMemoryBudget(int64 budget);
+    int64 getTextureMemoryBudget() { return m_textureMemoryBudget; }
+    int64 getTextureMemoryUsage() { return m_textureMemoryUsage; }
+    int64 getTextureMemoryPeak() { return m_textureMemoryPeak; }
+    int getLoadedTextures() { return m_textures.size(); }
+    int getReleasedTextures() { return m_releasedTextures; }
+
+    /// Schedules the sprites decoding of a thing type animation phase in the async dispatcher,
+    /// finished textures are uploaded by uploadTextures once per frame while the upload time budget lasts
+    void requestTexture(ThingType* thingType, int animationPhase);
+    ThingTextureDataPtr waitTexture(ThingType* thingType, int animationPhase);
+    void cancelTextures();
+    void uploadTextures();
+    int getPendingTextures() { return m_textureBuilds.size(); }
+
+    void invalidateThingTypeIndex() { m_thingAttrIndex.clear(); }
+
     bool isValidDatId(uint16 id, ThingCategory category) { return id >= 1 && id < m_thingTypes[category].size(); }
     bool isValidOtbId(uint16 id) { return id >= 1 && id < m_itemTypes.size(); }
 
 private:
+    std::string getSnapshotFile(SnapshotKind kind, uint32 hash);
+    FileStreamPtr openSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash);
+    FileStreamPtr createSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash);
+    bool loadDatSnapshot(uint32 hash, uint32 size);
+    void saveDatSnapshot(uint32 hash, uint32 size);
+    bool loadItemsSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash);
+    void saveItemsSnapshot(SnapshotKind kind, uint32 hash, uint32 size, uint32 parentHash);
+
+    void buildItemIndex();
+    std::vector<int> findItemNames(const std::string& text);
+
+    void releaseTextures(int64 neededMemory);
+
+    // must be declared before thing types, they release their textures when destroyed
+    ThingTextureList m_textures;
+    int64 m_textureMemoryBudget;
+    int64 m_textureMemoryUsage;
+    int64 m_textureMemoryPeak;
+    int m_releasedTextures;
+    std::map<std::pair<ThingType*, int>, TextureBuild> m_textureBuilds;
+    ticks_t m_textureUploadFrame;
+
     ThingTypeList m_thingTypes[ThingLastCategory];
     ItemTypeList m_reverseItemTypes;
     ItemTypeList m_itemTypes;
 
+    // item search indexes, rebuilt by the first search after the item types change
+    std::vector<std::string> m_itemNames;
+    std::vector<std::vector<uint16>> m_itemNameIds;
+    std::unordered_map<std::string, int> m_itemNameIndex;
+    std::unordered_map<uint32, std::vector<int>> m_itemTrigrams;
+    ItemTypeList m_itemCategories[ItemCategoryLast];
+    stdext::boolean<true> m_itemIndexDirty;
+    std::map<std::pair<int, int>, ThingTypeList> m_thingAttrIndex;
+
     ThingTypePtr m_nullThingType;
     ItemTypePtr m_nullItemType;
 
@@ -87,6 +178,15 @@ private:
     bool m_xmlLoaded;
     bool m_otbLoaded;
 
+    stdext::boolean<true> m_snapshotsEnabled;
+    stdext::boolean<false> m_datFromSnapshot;
+    stdext::boolean<false> m_otbFromSnapshot;
+    stdext::boolean<false> m_xmlFromSnapshot;
+    ticks_t m_datLoadTime;
+    ticks_t m_otbLoadTime;
+    ticks_t m_xmlLoadTime;
+    uint32 m_otbHash;
+
     uint32 m_otbMinorVersion;
     uint32 m_otbMajorVersion;
     uint32 m_datSignature;
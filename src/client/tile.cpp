@@ -31,6 +31,12 @@
 #include "lightview.h"
 #include <framework/graphics/fontmanager.h>
 
+stdext::object_pool<Tile>& Tile::getPool()
+{
+    static stdext::object_pool<Tile> *pool = new stdext::object_pool<Tile>;
+    return *pool;
+}
+
 Tile::Tile(const Position& position) :
     m_position(position),
     m_drawElevation(0),
@@ -145,6 +151,84 @@ void Tile::draw(const Point& dest, float scaleFactor, int drawFlags, LightView *
     }
 }
 
+void Tile::prepareDraw(const Point& dest, float scaleFactor, int drawFlags, bool lit, DrawList& drawList)
+{
+    // mirrors draw() for tiles without creatures, effects and missiles, items are read without copying their pointers
+    bool animate = drawFlags & Otc::DrawAnimations;
+
+    static const tileflags_t flags[] = {
+        TILESTATE_HOUSE,
+        TILESTATE_PROTECTIONZONE,
+        TILESTATE_OPTIONALZONE,
+        TILESTATE_HARDCOREZONE,
+        TILESTATE_REFRESH,
+        TILESTATE_NOLOGOUT,
+        TILESTATE_LAST
+    };
+
+    // first bottom items
+    if(drawFlags & (Otc::DrawGround | Otc::DrawGroundBorders | Otc::DrawOnBottom)) {
+        m_drawElevation = 0;
+        for(const ThingPtr& thing : m_things) {
+            if(!thing->isGround() && !thing->isGroundBorder() && !thing->isOnBottom())
+                break;
+
+            Color color = Color::white;
+            float opacity = 1.0f;
+            if(g_map.showZones() && thing->isGround()) {
+                for(auto flag: flags) {
+                    if(hasFlag(flag) && g_map.showZone(flag)) {
+                        opacity = g_map.getZoneOpacity();
+                        color = g_map.getZoneColor(flag);
+                        break;
+                    }
+                }
+            }
+            if(m_selected)
+                color = Color::teal;
+
+            if(thing->isItem() && ((thing->isGround() && drawFlags & Otc::DrawGround) ||
+               (thing->isGroundBorder() && drawFlags & Otc::DrawGroundBorders) ||
+               (thing->isOnBottom() && drawFlags & Otc::DrawOnBottom)))
+                static_cast<Item*>(thing.get())->prepareDraw(dest - m_drawElevation*scaleFactor, animate, lit, color, opacity, drawList);
+
+            m_drawElevation += thing->getElevation();
+            if(m_drawElevation > Otc::MAX_ELEVATION)
+                m_drawElevation = Otc::MAX_ELEVATION;
+        }
+    }
+
+    if(drawFlags & Otc::DrawItems) {
+        // now common items in reverse order
+        for(auto it = m_things.rbegin(); it != m_things.rend(); ++it) {
+            const ThingPtr& thing = *it;
+            if(thing->isOnTop() || thing->isOnBottom() || thing->isGroundBorder() || thing->isGround() || thing->isCreature())
+                break;
+            if(thing->isItem())
+                static_cast<Item*>(thing.get())->prepareDraw(dest - m_drawElevation*scaleFactor, animate, lit, Color::white, 1.0f, drawList);
+            m_drawElevation += thing->getElevation();
+            if(m_drawElevation > Otc::MAX_ELEVATION)
+                m_drawElevation = Otc::MAX_ELEVATION;
+        }
+    }
+
+    // top items
+    if(drawFlags & Otc::DrawOnTop)
+        for(const ThingPtr& thing : m_things)
+            if(thing->isOnTop() && thing->isItem())
+                static_cast<Item*>(thing.get())->prepareDraw(dest, animate, lit, Color::white, 1.0f, drawList);
+
+    // translucent light (for tiles beneath holes)
+    if(hasTranslucentLight() && lit) {
+        DrawCommand command;
+        command.thingType = nullptr;
+        command.animator = nullptr;
+        command.dest = dest + Point(16,16) * scaleFactor;
+        command.lit = true;
+        drawList.push_back(command);
+    }
+}
+
 void Tile::clean()
 {
     while(!m_things.empty())
@@ -208,6 +292,8 @@ void Tile::addThing(const ThingPtr& thing, int stackPos)
             stackPos = m_things.size();
 
         m_things.insert(m_things.begin() + stackPos, thing);
+        if(thing->isItem())
+            g_map.addItemToIndex(thing->getId(), m_position);
 
         if(m_things.size() > MAX_THINGS)
             removeThing(m_things[MAX_THINGS]);
@@ -249,6 +335,8 @@ bool Tile::removeThing(ThingPtr thing)
         auto it = std::find(m_things.begin(), m_things.end(), thing);
         if(it != m_things.end()) {
             m_things.erase(it);
+            if(thing->isItem())
+                g_map.removeItemFromIndex(thing->getId(), m_position);
             removed = true;
         }
     }
@@ -502,10 +590,11 @@ bool Tile::isPathable()
 
 bool Tile::isFullGround()
 {
-    ItemPtr ground = getGround();
-    if(ground && ground->isFullGround())
-        return true;
-    return false;
+    // the ground is read by reference, map draws may be prepared in worker threads
+    if(m_things.empty())
+        return false;
+    const ThingPtr& ground = m_things.front();
+    return ground->isGround() && ground->isItem() && ground->isFullGround();
 }
 
 bool Tile::isFullyOpaque()
@@ -62,7 +62,12 @@ public:
 
     Tile(const Position& position);
 
+    void *operator new(size_t size) { return getPool().allocate(size); }
+    void operator delete(void *p, size_t size) { getPool().deallocate(p, size); }
+    static stdext::object_pool<Tile>& getPool();
+
     void draw(const Point& dest, float scaleFactor, int drawFlags, LightView *lightView = nullptr);
+    void prepareDraw(const Point& dest, float scaleFactor, int drawFlags, bool lit, DrawList& drawList);
 
 public:
     void clean();
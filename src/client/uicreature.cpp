@@ -21,8 +21,11 @@
  */
 
 #include "uicreature.h"
+#include "map.h"
 #include <framework/otml/otml.h>
 #include <framework/graphics/graphics.h>
+#include <framework/core/application.h>
+#include <framework/core/clock.h>
 
 void UICreature::drawSelf(Fw::DrawPane drawPane)
 {
@@ -34,7 +37,13 @@ void UICreature::drawSelf(Fw::DrawPane drawPane)
     if(m_creature) {
         Rect drawRect = getPaddingRect();
         g_painter->setColor(m_imageColor);
+        g_map.resetAnimationFrame();
         m_creature->drawOutfit(drawRect, !m_fixedCreatureSize);
+
+        // idle animated outfits damage the foreground again when their phase changes
+        ticks_t nextAnimationFrame = g_map.getNextAnimationFrame();
+        if(nextAnimationFrame != std::numeric_limits<ticks_t>::max())
+            g_app.scheduleRepaint(std::max<ticks_t>(0, nextAnimationFrame - g_clock.millis()));
     }
 }
 
@@ -44,6 +53,7 @@ void UICreature::setOutfit(const Outfit& outfit)
         m_creature = CreaturePtr(new Creature);
     m_creature->setDirection(Otc::South);
     m_creature->setOutfit(outfit);
+    repaint();
 }
 
 void UICreature::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -21,9 +21,12 @@
  */
 
 #include "uiitem.h"
+#include "map.h"
 #include <framework/otml/otml.h>
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/fontmanager.h>
+#include <framework/core/application.h>
+#include <framework/core/clock.h>
 
 UIItem::UIItem()
 {
@@ -56,8 +59,14 @@ void UIItem::drawSelf(Fw::DrawPane drawPane)
         dest += (m_item->getDisplacement() - Point(32,32)) * scaleFactor;
 
         g_painter->setColor(m_color);
+        g_map.resetAnimationFrame();
         m_item->draw(dest, scaleFactor, true);
 
+        // animated items damage the foreground again when their phase changes
+        ticks_t nextAnimationFrame = g_map.getNextAnimationFrame();
+        if(nextAnimationFrame != std::numeric_limits<ticks_t>::max())
+            g_app.scheduleRepaint(std::max<ticks_t>(0, nextAnimationFrame - g_clock.millis()));
+
         if(m_font && (m_item->isStackable() || m_item->isChargeable()) && m_item->getCountOrSubType() > 1) {
             std::string count = stdext::to_string(m_item->getCountOrSubType());
             g_painter->setColor(Color(231, 231, 231));
@@ -84,6 +93,7 @@ void UIItem::setItemId(int id)
         else
             m_item->setId(id);
     }
+    repaint();
 }
 
 void UIItem::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
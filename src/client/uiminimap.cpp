@@ -65,6 +65,7 @@ bool UIMinimap::setZoom(int zoom)
     else
         m_scale = 1;
     m_layout->update();
+    repaint();
 
     onZoomChange(zoom, oldZoom);
     return true;
@@ -75,6 +76,7 @@ void UIMinimap::setCameraPosition(const Position& pos)
     Position oldPos = m_cameraPosition;
     m_cameraPosition = pos;
     m_layout->update();
+    repaint();
 
     onCameraPositionChange(pos, oldPos);
 }
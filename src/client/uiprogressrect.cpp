@@ -85,6 +85,7 @@ void UIProgressRect::drawSelf(Fw::DrawPane drawPane)
 void UIProgressRect::setPercent(float percent)
 {
     m_percent = stdext::clamp<float>(percent, 0.f, 100.f);
+    repaint();
 }
 
 void UIProgressRect::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -28,6 +28,7 @@
 #include <framework/core/eventdispatcher.h>
 #include <framework/core/configmanager.h>
 #include "asyncdispatcher.h"
+#include "profiler.h"
 #include <framework/luaengine/luainterface.h>
 #include <framework/platform/crashhandler.h>
 #include <framework/platform/platform.h>
@@ -60,6 +61,7 @@ Application::Application()
     m_appCompactName = "app";
     m_appVersion = "none";
     m_charset = "cp1252";
+    m_polledEvents = 0;
     m_stopping = false;
 }
 
@@ -80,6 +82,9 @@ void Application::init(std::vector<std::string>& args)
     g_platform.processArgs(args);
 
     g_asyncDispatcher.init();
+    // frame work never queues behind background loads, one worker for each spare core
+    g_frameDispatcher.init(std::max<int>(1, (int)std::thread::hardware_concurrency() - 1));
+    g_profiler.init();
 
     std::string startupOptions;
     for(uint i=1;i<args.size();++i) {
@@ -118,6 +123,7 @@ void Application::deinit()
     poll();
 
     g_asyncDispatcher.terminate();
+    g_frameDispatcher.terminate();
 
     // disable dispatcher events
     g_dispatcher.shutdown();
@@ -139,6 +145,8 @@ void Application::terminate()
     // terminate script environment
     g_lua.terminate();
 
+    g_profiler.terminate();
+
     m_terminated = true;
 
     signal(SIGTERM, SIG_DFL);
@@ -147,15 +155,25 @@ void Application::terminate()
 
 void Application::poll()
 {
+    // counts the network handlers and events executed in this poll
+    m_polledEvents = 0;
+
 #ifdef FW_NET
-    Connection::poll();
+    {
+        ProfilerZone zone("network");
+        m_polledEvents += Connection::poll();
+    }
 #endif
 
-    g_dispatcher.poll();
+    {
+        ProfilerZone zone("dispatcher");
+        m_polledEvents += g_dispatcher.poll();
+    }
 
     // poll connection again to flush pending write
 #ifdef FW_NET
-    Connection::poll();
+    ProfilerZone zone("network");
+    m_polledEvents += Connection::poll();
 #endif
 }
 
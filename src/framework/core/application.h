@@ -61,6 +61,7 @@ public:
     std::string getBuildArch() { return BUILD_ARCH; }
     std::string getOs();
     std::string getStartupOptions() { return m_startupOptions; }
+    int getPolledEvents() { return m_polledEvents; }
 
 protected:
     void registerLuaFunctions();
@@ -70,6 +71,7 @@ protected:
     std::string m_appCompactName;
     std::string m_appVersion;
     std::string m_startupOptions;
+    int m_polledEvents;
     stdext::boolean<false> m_running;
     stdext::boolean<false> m_stopping;
     stdext::boolean<false> m_terminated;
@@ -23,10 +23,12 @@
 #include "asyncdispatcher.h"
 
 AsyncDispatcher g_asyncDispatcher;
+AsyncDispatcher g_frameDispatcher;
 
-void AsyncDispatcher::init()
+void AsyncDispatcher::init(int threads)
 {
-    spawn_thread();
+    for(int i = 0; i < threads; ++i)
+        spawn_thread();
 }
 
 void AsyncDispatcher::terminate()
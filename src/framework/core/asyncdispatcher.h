@@ -28,7 +28,7 @@
 
 class AsyncDispatcher {
 public:
-    void init();
+    void init(int threads = 1);
     void terminate();
 
     void spawn_thread();
@@ -55,5 +55,6 @@ private:
 };
 
 extern AsyncDispatcher g_asyncDispatcher;
+extern AsyncDispatcher g_frameDispatcher;
 
 #endif
@@ -40,8 +40,9 @@ void EventDispatcher::shutdown()
     m_disabled = true;
 }
 
-void EventDispatcher::poll()
+int EventDispatcher::poll()
 {
+    int executedEvents = 0;
     int loops = 0;
     for(int count = 0, max = m_scheduledEventList.size(); count < max && !m_scheduledEventList.empty(); ++count) {
         ScheduledEventPtr scheduledEvent = m_scheduledEventList.top();
@@ -49,6 +50,7 @@ void EventDispatcher::poll()
             break;
         m_scheduledEventList.pop();
         scheduledEvent->execute();
+        executedEvents++;
 
         if(scheduledEvent->nextCycle())
             m_scheduledEventList.push(scheduledEvent);
@@ -73,10 +75,12 @@ void EventDispatcher::poll()
             m_eventList.pop_front();
             event->execute();
         }
+        executedEvents += m_pollEventsSize;
         m_pollEventsSize = m_eventList.size();
 
         loops++;
     }
+    return executedEvents;
 }
 
 ScheduledEventPtr EventDispatcher::scheduleEvent(const std::function<void()>& callback, int delay)
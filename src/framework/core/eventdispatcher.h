@@ -33,7 +33,7 @@ class EventDispatcher
 {
 public:
     void shutdown();
-    void poll();
+    int poll();
 
     EventPtr addEvent(const std::function<void()>& callback, bool pushFront = false);
     ScheduledEventPtr scheduleEvent(const std::function<void()>& callback, int delay);
@@ -24,12 +24,15 @@
 #include "graphicalapplication.h"
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/profiler.h>
 #include <framework/platform/platformwindow.h>
 #include <framework/ui/uimanager.h>
 #include <framework/graphics/graphics.h>
 #include <framework/graphics/particlemanager.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/graphics/painter.h>
+#include <framework/graphics/fontmanager.h>
+#include <framework/graphics/bitmapfont.h>
 #include <framework/input/mouse.h>
 
 #ifdef FW_SOUND
@@ -42,6 +45,11 @@ void GraphicalApplication::init(std::vector<std::string>& args)
 {
     Application::init(args);
 
+    m_repaintTime = 0;
+    m_backgroundRepaintTime = 0;
+    m_renderedFrames = 0;
+    m_skippedFrames = 0;
+
     // setup platform window
     g_window.init();
     g_window.hide();
@@ -127,9 +135,15 @@ void GraphicalApplication::run()
 
     g_lua.callGlobalField("g_app", "onRun");
 
+    // lua garbage is collected in the idle time between frames from now on
+    g_lua.setGarbageCollectorPaced(true);
+
     while(!m_stopping) {
         // poll all events before rendering
-        poll();
+        {
+            ProfilerZone zone("poll");
+            poll();
+        }
 
         if(g_window.isVisible()) {
             // the screen consists of two panes
@@ -140,13 +154,34 @@ void GraphicalApplication::run()
 
             bool cacheForeground = g_graphics.canCacheBackbuffer() && m_foregroundFrameCounter.getMaxFps() != 0;
 
+            if(m_repaintTime > 0 && g_clock.millis() >= m_repaintTime) {
+                m_repaintTime = 0;
+                m_mustRepaint = true;
+            }
+            if(m_backgroundRepaintTime > 0 && g_clock.millis() >= m_backgroundRepaintTime) {
+                m_backgroundRepaintTime = 0;
+                m_mustRepaintBackground = true;
+            }
+
             if(m_backgroundFrameCounter.shouldProcessNextFrame()) {
-                redraw = true;
+                if(!m_damageTracking) {
+                    redraw = true;
 
-                if(m_mustRepaint || m_foregroundFrameCounter.shouldProcessNextFrame()) {
-                    m_mustRepaint = false;
-                    updateForeground = true;
+                    if(m_mustRepaint || m_foregroundFrameCounter.shouldProcessNextFrame()) {
+                        m_mustRepaint = false;
+                        updateForeground = true;
+                    }
+                } else {
+                    // only damaged panes are drawn, the foreground still respects its max fps
+                    if(m_mustRepaint && (!cacheForeground || m_foregroundFrameCounter.shouldProcessNextFrame())) {
+                        m_mustRepaint = false;
+                        updateForeground = true;
+                    }
+                    redraw = updateForeground || m_mustRepaintBackground;
+                    if(!redraw)
+                        m_skippedFrames++;
                 }
+                m_mustRepaintBackground = false;
             }
 
             if(redraw) {
@@ -183,8 +218,16 @@ void GraphicalApplication::run()
                     g_ui.render(Fw::BothPanes);
                 }
 
+                if(g_profiler.isOverlayVisible())
+                    drawProfilerOverlay();
+
                 // update screen pixels
-                g_window.swapBuffers();
+                {
+                    ProfilerZone zone("swap");
+                    g_window.swapBuffers();
+                }
+                g_profiler.markFrame();
+                m_renderedFrames++;
             }
 
             // only update the current time once per frame to gain performance
@@ -195,20 +238,47 @@ void GraphicalApplication::run()
             m_foregroundFrameCounter.update();
 
             int sleepMicros = m_backgroundFrameCounter.getMaximumSleepMicros();
+
+            // nothing is damaged, wait for input, network or timer events like an hidden window
+            if(m_damageTracking && !redraw && !m_mustRepaint && !m_mustRepaintBackground)
+                sleepMicros = std::max<int>(sleepMicros, POLL_CYCLE_DELAY*1000);
+
+            // spend the time left in this frame collecting lua garbage
+            sleepMicros -= g_lua.stepGarbageCollector(sleepMicros - AdaptativeFrameCounter::MINIMUM_MICROS_SLEEP);
+
             if(sleepMicros >= AdaptativeFrameCounter::MINIMUM_MICROS_SLEEP)
                 stdext::microsleep(sleepMicros);
 
         } else {
+            g_lua.stepGarbageCollector(POLL_CYCLE_DELAY*1000);
+
             // sleeps until next poll to avoid massive cpu usage
             stdext::millisleep(POLL_CYCLE_DELAY+1);
             g_clock.update();
         }
     }
 
+    g_lua.setGarbageCollectorPaced(false);
+
     m_stopping = false;
     m_running = false;
 }
 
+void GraphicalApplication::drawProfilerOverlay()
+{
+    const std::string& report = g_profiler.getReport();
+    BitmapFontPtr font = g_fonts.getDefaultFont();
+    if(report.empty() || !font)
+        return;
+
+    Size size = font->calculateTextRectSize(report);
+    Rect rect(Point(8, 8), size + Size(8, 8));
+    g_painter->setColor(Color(0, 0, 0, 192));
+    g_painter->drawFilledRect(rect);
+    g_painter->setColor(Color::white);
+    font->drawText(report, rect.expanded(-4));
+}
+
 void GraphicalApplication::poll()
 {
 #ifdef FW_SOUND
@@ -249,4 +319,36 @@ void GraphicalApplication::inputEvent(const InputEvent& event)
     m_onInputEvent = true;
     g_ui.inputEvent(event);
     m_onInputEvent = false;
+
+    if(m_damageTracking)
+        m_mustRepaint = true;
+}
+
+void GraphicalApplication::scheduleRepaint(int delay)
+{
+    // scheduled repaints are only needed when frames are not drawn continuously
+    if(!m_damageTracking)
+        return;
+
+    ticks_t time = g_clock.millis() + delay;
+    if(m_repaintTime == 0 || time < m_repaintTime)
+        m_repaintTime = time;
+}
+
+void GraphicalApplication::scheduleBackgroundRepaint(int delay)
+{
+    if(!m_damageTracking)
+        return;
+
+    ticks_t time = g_clock.millis() + delay;
+    if(m_backgroundRepaintTime == 0 || time < m_backgroundRepaintTime)
+        m_backgroundRepaintTime = time;
+}
+
+void GraphicalApplication::setDamageTracking(bool enable)
+{
+    m_damageTracking = enable;
+    m_repaintTime = 0;
+    m_backgroundRepaintTime = 0;
+    m_mustRepaint = true;
 }
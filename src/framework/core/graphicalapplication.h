@@ -44,6 +44,11 @@ public:
 
     bool willRepaint() { return m_mustRepaint; }
     void repaint() { m_mustRepaint = true; }
+    void repaintBackground() { m_mustRepaintBackground = true; }
+    void scheduleRepaint(int delay);
+    void scheduleBackgroundRepaint(int delay);
+
+    void setDamageTracking(bool enable);
 
     void setForegroundPaneMaxFps(int maxFps) { m_foregroundFrameCounter.setMaxFps(maxFps); }
     void setBackgroundPaneMaxFps(int maxFps) { m_backgroundFrameCounter.setMaxFps(maxFps); }
@@ -53,15 +58,27 @@ public:
     int getForegroundPaneMaxFps() { return m_foregroundFrameCounter.getMaxFps(); }
     int getBackgroundPaneMaxFps() { return m_backgroundFrameCounter.getMaxFps(); }
 
+    int getRenderedFrames() { return m_renderedFrames; }
+    int getSkippedFrames() { return m_skippedFrames; }
+    void resetFrameStats() { m_renderedFrames = 0; m_skippedFrames = 0; }
+
     bool isOnInputEvent() { return m_onInputEvent; }
+    bool isDamageTracking() { return m_damageTracking; }
 
 protected:
     void resize(const Size& size);
     void inputEvent(const InputEvent& event);
+    void drawProfilerOverlay();
 
 private:
     stdext::boolean<false> m_onInputEvent;
     stdext::boolean<false> m_mustRepaint;
+    stdext::boolean<false> m_mustRepaintBackground;
+    stdext::boolean<false> m_damageTracking;
+    ticks_t m_repaintTime;
+    ticks_t m_backgroundRepaintTime;
+    int m_renderedFrames;
+    int m_skippedFrames;
     AdaptativeFrameCounter m_backgroundFrameCounter;
     AdaptativeFrameCounter m_foregroundFrameCounter;
     TexturePtr m_foreground;
@@ -99,6 +99,7 @@ void Logger::log(Fw::LogLevel level, const std::string& message)
 
         // NOTE: Threads must finish before the process can exit.
         g_asyncDispatcher.terminate();
+        g_frameDispatcher.terminate();
 
         exit(-1);
     }
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "profiler.h"
+#include "resourcemanager.h"
+
+Profiler g_profiler;
+
+void Profiler::init()
+{
+    m_eventsCount = 0;
+    m_framesCount = 0;
+    m_depth = 0;
+}
+
+void Profiler::terminate()
+{
+    m_enabled = false;
+    clear();
+    m_events.clear();
+    m_events.shrink_to_fit();
+    m_frames.clear();
+    m_frames.shrink_to_fit();
+}
+
+void Profiler::setEnabled(bool enable)
+{
+    if(enable && m_events.empty()) {
+        m_events.resize(MAX_EVENTS);
+        m_frames.resize(MAX_FRAMES);
+    }
+    m_enabled = enable;
+}
+
+void Profiler::beginZone(const char *zone)
+{
+    // zones nested deeper than the limit are counted but not recorded
+    if(m_depth < MAX_DEPTH) {
+        OpenZone& openZone = m_openZones[m_depth];
+        openZone.zone = zone;
+        openZone.start = stdext::micros();
+        openZone.recursive = false;
+        for(int i = 0; i < m_depth; ++i) {
+            if(m_openZones[i].zone == zone) {
+                openZone.recursive = true;
+                break;
+            }
+        }
+    }
+    m_depth++;
+}
+
+void Profiler::endZone()
+{
+    if(m_depth == 0)
+        return;
+
+    m_depth--;
+    if(m_depth >= MAX_DEPTH || m_events.empty())
+        return;
+
+    const OpenZone& openZone = m_openZones[m_depth];
+    ZoneEvent& event = m_events[m_eventsCount % MAX_EVENTS];
+    event.zone = openZone.zone;
+    event.start = openZone.start;
+    event.duration = stdext::micros() - openZone.start;
+    event.depth = m_depth;
+    event.recursive = openZone.recursive;
+    m_eventsCount++;
+}
+
+void Profiler::markFrame()
+{
+    if(!m_enabled || m_frames.empty())
+        return;
+
+    Frame& frame = m_frames[m_framesCount % MAX_FRAMES];
+    frame.start = stdext::micros();
+    frame.firstEvent = m_eventsCount;
+    m_framesCount++;
+}
+
+void Profiler::clear()
+{
+    m_eventsCount = 0;
+    m_framesCount = 0;
+    m_report.clear();
+}
+
+const std::string& Profiler::getReport()
+{
+    if(m_reportTimer.ticksElapsed() < REPORT_DELAY && !m_report.empty())
+        return m_report;
+    m_reportTimer.restart();
+    m_report.clear();
+
+    if(m_framesCount < 2)
+        return m_report;
+
+    struct ZoneStats {
+        ticks_t total;
+        ticks_t max;
+        ticks_t frame;
+    };
+    std::map<std::string, ZoneStats> zones;
+    ticks_t framesTotal = 0;
+    ticks_t framesMax = 0;
+
+    uint64 lastFrame = m_framesCount - 1;
+    uint64 firstFrame = std::max<uint64>(getFirstFrame(), lastFrame - std::min<uint64>(lastFrame, REPORT_FRAMES));
+    uint64 firstEvent = getFirstEvent();
+    int frames = lastFrame - firstFrame;
+
+    for(uint64 f = firstFrame; f < lastFrame; ++f) {
+        const Frame& frame = getFrame(f);
+        const Frame& nextFrame = getFrame(f + 1);
+        ticks_t frameTime = nextFrame.start - frame.start;
+        framesTotal += frameTime;
+        framesMax = std::max<ticks_t>(framesMax, frameTime);
+
+        for(uint64 e = std::max<uint64>(frame.firstEvent, firstEvent); e < nextFrame.firstEvent; ++e) {
+            const ZoneEvent& event = getEvent(e);
+            // recursive zones are already accounted by their outer zone
+            if(event.recursive)
+                continue;
+            zones[event.zone].frame += event.duration;
+        }
+
+        for(auto& it : zones) {
+            ZoneStats& stats = it.second;
+            stats.total += stats.frame;
+            stats.max = std::max<ticks_t>(stats.max, stats.frame);
+            stats.frame = 0;
+        }
+    }
+
+    m_report = stdext::format("%-12s avg %6.2fms max %6.2fms\n", "frame", framesTotal / (frames * 1000.0), framesMax / 1000.0);
+    for(auto& it : zones)
+        m_report += stdext::format("%-12s avg %6.2fms max %6.2fms\n", it.first, it.second.total / (frames * 1000.0), it.second.max / 1000.0);
+    return m_report;
+}
+
+bool Profiler::exportTrace(const std::string& fileName)
+{
+    std::stringstream ss;
+    ss << "{\"traceEvents\":[";
+
+    bool first = true;
+    for(uint64 e = getFirstEvent(); e < m_eventsCount; ++e) {
+        const ZoneEvent& event = getEvent(e);
+        ss << (first ? "" : ",") << "\n{\"name\":\"" << event.zone << "\",\"ph\":\"X\",\"ts\":" << event.start << ",\"dur\":" << event.duration << ",\"pid\":1,\"tid\":1}";
+        first = false;
+    }
+
+    for(uint64 f = getFirstFrame(); f < m_framesCount; ++f) {
+        ss << (first ? "" : ",") << "\n{\"name\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"ts\":" << getFrame(f).start << ",\"pid\":1,\"tid\":1}";
+        first = false;
+    }
+
+    ss << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return g_resources.writeFileContents(fileName, ss.str());
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "declarations.h"
+#include "timer.h"
+
+// @bindsingleton g_profiler
+class Profiler
+{
+public:
+    enum {
+        MAX_EVENTS = 65536,
+        MAX_FRAMES = 256,
+        MAX_DEPTH = 32,
+        REPORT_FRAMES = 60,
+        REPORT_DELAY = 500
+    };
+
+    void init();
+    void terminate();
+
+    /// Zones are only recorded while enabled, the most recent zones and frames are kept in ring buffers
+    void setEnabled(bool enable);
+    void setOverlayVisible(bool visible) { m_overlayVisible = visible; }
+
+    bool isEnabled() { return m_enabled; }
+    bool isOverlayVisible() { return m_overlayVisible; }
+
+    void beginZone(const char *zone);
+    void endZone();
+    void markFrame();
+    void clear();
+
+    /// Average and worst frame times of each zone over the last frames
+    const std::string& getReport();
+    /// Saves the recorded zones in the chrome trace event format (chrome://tracing)
+    bool exportTrace(const std::string& fileName);
+
+private:
+    struct ZoneEvent {
+        const char *zone;
+        ticks_t start;
+        ticks_t duration;
+        uint8 depth;
+        bool recursive;
+    };
+
+    struct OpenZone {
+        const char *zone;
+        ticks_t start;
+        bool recursive;
+    };
+
+    struct Frame {
+        ticks_t start;
+        uint64 firstEvent;
+    };
+
+    const ZoneEvent& getEvent(uint64 index) { return m_events[index % MAX_EVENTS]; }
+    const Frame& getFrame(uint64 index) { return m_frames[index % MAX_FRAMES]; }
+    uint64 getFirstEvent() { return m_eventsCount > MAX_EVENTS ? m_eventsCount - MAX_EVENTS : 0; }
+    uint64 getFirstFrame() { return m_framesCount > MAX_FRAMES ? m_framesCount - MAX_FRAMES : 0; }
+
+    std::vector<ZoneEvent> m_events;
+    std::vector<Frame> m_frames;
+    std::array<OpenZone, MAX_DEPTH> m_openZones;
+    uint64 m_eventsCount;
+    uint64 m_framesCount;
+    int m_depth;
+    stdext::boolean<false> m_enabled;
+    stdext::boolean<false> m_overlayVisible;
+    std::string m_report;
+    Timer m_reportTimer;
+};
+
+extern Profiler g_profiler;
+
+// records a zone in the profiler for the lifetime of the object
+class ProfilerZone
+{
+public:
+    ProfilerZone(const char *zone) : m_active(g_profiler.isEnabled()) {
+        if(m_active)
+            g_profiler.beginZone(zone);
+    }
+    ~ProfilerZone() {
+        if(m_active)
+            g_profiler.endZone();
+    }
+
+private:
+    bool m_active;
+};
+
+#endif
@@ -22,23 +22,23 @@
 
 #include "animatedtexture.h"
 #include "graphics.h"
+#include "texturemanager.h"
 
-#include <framework/core/eventdispatcher.h>
+#include <framework/core/clock.h>
 
-AnimatedTexture::AnimatedTexture(const Size& size, std::vector<ImagePtr> frames, std::vector<int> framesDelay, bool buildMipmaps, bool compress)
+AnimatedTexture::AnimatedTexture()
 {
-    if(!setupSize(size, buildMipmaps))
-        return;
-
-    for(const auto &frame: frames) {
-        m_frames.push_back(new Texture(frame, buildMipmaps, compress));
-    }
+    m_currentFrame = 0;
+    m_nextFrameTime = 0;
+    m_lastDrawTime = 0;
+}
 
-    m_framesDelay = framesDelay;
-    m_hasMipmaps = buildMipmaps;
-    m_id = m_frames[0]->getId();
+AnimatedTexture::AnimatedTexture(const Size& size, std::vector<ImagePtr> frames, std::vector<int> framesDelay, bool buildMipmaps, bool compress)
+{
     m_currentFrame = 0;
-    m_animTimer.restart();
+    m_nextFrameTime = 0;
+    m_lastDrawTime = 0;
+    setFrames(size, frames, framesDelay, buildMipmaps, compress);
 }
 
 AnimatedTexture::~AnimatedTexture()
@@ -70,14 +70,61 @@ void AnimatedTexture::setRepeat(bool repeat)
     m_repeat = repeat;
 }
 
+void AnimatedTexture::setFrames(const Size& size, const std::vector<ImagePtr>& frames, const std::vector<int>& framesDelay, bool buildMipmaps, bool compress)
+{
+    if(frames.empty() || !setupSize(size, buildMipmaps))
+        return;
+
+    m_frames.clear();
+    for(const auto &frame: frames) {
+        TexturePtr texture = new Texture(frame, buildMipmaps, compress);
+        texture->setSmooth(m_smooth);
+        texture->setRepeat(m_repeat);
+        m_frames.push_back(texture);
+    }
+
+    m_framesDelay = framesDelay;
+    m_hasMipmaps = buildMipmaps;
+    m_id = m_frames[0]->getId();
+    m_currentFrame = 0;
+    m_lastDrawTime = g_clock.millis();
+    m_nextFrameTime = m_lastDrawTime + std::max<int>(m_framesDelay[0], MINIMUM_FRAME_DELAY);
+}
+
 void AnimatedTexture::updateAnimation()
 {
-    if(m_animTimer.ticksElapsed() < m_framesDelay[m_currentFrame])
+    if(m_frames.empty())
+        return;
+
+    ticks_t now = g_clock.millis();
+    if(now < m_nextFrameTime)
         return;
 
-    m_animTimer.restart();
-    m_currentFrame++;
-    if(m_currentFrame >= m_frames.size())
-        m_currentFrame = 0;
+    // a long paused animation continues from the current time instead of skipping through its frames
+    if(now - m_nextFrameTime > HIDDEN_DELAY)
+        m_nextFrameTime = now;
+
+    while(now >= m_nextFrameTime) {
+        m_currentFrame++;
+        if(m_currentFrame >= m_frames.size())
+            m_currentFrame = 0;
+        m_nextFrameTime += std::max<int>(m_framesDelay[m_currentFrame], MINIMUM_FRAME_DELAY);
+    }
     m_id = m_frames[m_currentFrame]->getId();
 }
+
+void AnimatedTexture::markDrawn()
+{
+    m_lastDrawTime = g_clock.millis();
+
+    // paused animations are scheduled again once they get drawn
+    if(m_paused) {
+        m_paused = false;
+        g_textures.scheduleAnimation(static_self_cast<AnimatedTexture>());
+    }
+}
+
+bool AnimatedTexture::isHidden()
+{
+    return g_clock.millis() - m_lastDrawTime > HIDDEN_DELAY;
+}
@@ -24,11 +24,16 @@
 #define ANIMATEDTEXTURE_H
 
 #include "texture.h"
-#include <framework/core/timer.h>
 
 class AnimatedTexture : public Texture
 {
+    enum {
+        MINIMUM_FRAME_DELAY = 16,
+        HIDDEN_DELAY = 1000
+    };
+
 public:
+    AnimatedTexture();
     AnimatedTexture(const Size& size, std::vector<ImagePtr> frames, std::vector<int> framesDelay, bool buildMipmaps = false, bool compress = false);
     virtual ~AnimatedTexture();
 
@@ -37,15 +42,23 @@ public:
     virtual void setSmooth(bool smooth);
     virtual void setRepeat(bool repeat);
 
+    void setFrames(const Size& size, const std::vector<ImagePtr>& frames, const std::vector<int>& framesDelay, bool buildMipmaps = false, bool compress = false);
     void updateAnimation();
+    void markDrawn();
+    void pause() { m_paused = true; }
 
+    ticks_t getNextFrameTime() { return m_nextFrameTime; }
+    bool isPaused() { return m_paused; }
+    bool isHidden();
     virtual bool isAnimatedTexture() { return true; }
 
 private:
     std::vector<TexturePtr> m_frames;
     std::vector<int> m_framesDelay;
     uint m_currentFrame;
-    Timer m_animTimer;
+    ticks_t m_nextFrameTime;
+    ticks_t m_lastDrawTime;
+    stdext::boolean<false> m_paused;
 };
 
 #endif
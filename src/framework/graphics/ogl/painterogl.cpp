@@ -22,6 +22,7 @@
 
 #include "painterogl.h"
 #include <framework/graphics/graphics.h>
+#include <framework/graphics/animatedtexture.h>
 #include <framework/platform/platformwindow.h>
 
 PainterOGL::PainterOGL()
@@ -143,6 +144,10 @@ void PainterOGL::setClipRect(const Rect& clipRect)
 
 void PainterOGL::setTexture(Texture* texture)
 {
+    // animated textures only advance while they are being drawn
+    if(texture && texture->isAnimatedTexture())
+        static_cast<AnimatedTexture*>(texture)->markDrawn();
+
     if(m_texture == texture)
         return;
 
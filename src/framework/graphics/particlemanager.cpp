@@ -21,6 +21,7 @@
  */
 
 #include "particlemanager.h"
+#include <framework/core/application.h>
 #include <framework/core/resourcemanager.h>
 #include <framework/otml/otml.h>
 
@@ -83,4 +84,7 @@ void ParticleManager::poll()
             ++it;
         }
     }
+
+    if(!m_effects.empty())
+        g_app.scheduleRepaint(0);
 }
@@ -80,6 +80,10 @@ void Texture::uploadPixels(const ImagePtr& image, bool buildMipmaps, bool compre
     } else
         glImage = image;
 
+    // textures loaded asynchronously are created empty and only receive their pixels later
+    if(m_id == 0)
+        createTexture();
+
     bind();
 
     if(buildMipmaps) {
@@ -110,7 +114,7 @@ void Texture::copyFromScreen(const Rect& screenRect)
 
 bool Texture::buildHardwareMipmaps()
 {
-    if(!g_graphics.canUseHardwareMipmaps())
+    if(!g_graphics.canUseHardwareMipmaps() || m_id == 0)
         return false;
 
     bind();
@@ -133,6 +137,8 @@ void Texture::setSmooth(bool smooth)
         return;
 
     m_smooth = smooth;
+    if(m_id == 0)
+        return;
     bind();
     setupFilters();
 }
@@ -143,6 +149,8 @@ void Texture::setRepeat(bool repeat)
         return;
 
     m_repeat = repeat;
+    if(m_id == 0)
+        return;
     bind();
     setupWrap();
 }
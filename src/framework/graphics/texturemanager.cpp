@@ -28,10 +28,29 @@
 #include <framework/core/resourcemanager.h>
 #include <framework/core/clock.h>
 #include <framework/core/eventdispatcher.h>
+#include <framework/core/asyncdispatcher.h>
+#include <framework/core/graphicalapplication.h>
 #include <framework/graphics/apngloader.h>
 
 TextureManager g_textures;
 
+static bool isAnimatedPng(const std::string& data)
+{
+    // animated pngs declare their acTL chunk before the first IDAT chunk
+    size_t pos = 8;
+    while(pos + 8 <= data.size()) {
+        const uchar *chunk = (const uchar*)data.data() + pos;
+        uint32 length = (uint32)chunk[0] << 24 | (uint32)chunk[1] << 16 | (uint32)chunk[2] << 8 | (uint32)chunk[3];
+        std::string type = data.substr(pos + 4, 4);
+        if(type == "acTL")
+            return true;
+        if(type == "IDAT")
+            return false;
+        pos += length + 12;
+    }
+    return false;
+}
+
 void TextureManager::init()
 {
     m_emptyTexture = TexturePtr(new Texture);
@@ -43,27 +62,40 @@ void TextureManager::terminate()
         m_liveReloadEvent->cancel();
         m_liveReloadEvent = nullptr;
     }
+    m_textureLoads.clear();
+    m_loadCallbacks.clear();
     m_textures.clear();
-    m_animatedTextures.clear();
+    m_animations = std::priority_queue<ScheduledAnimation>();
     m_emptyTexture = nullptr;
 }
 
 void TextureManager::poll()
 {
-    // update only every 16msec, this allows upto 60 fps for animated textures
-    static ticks_t lastUpdate = 0;
+    if(!m_textureLoads.empty())
+        uploadTextures();
+
+    // only animations whose next frame is due are updated, hidden ones are paused until drawn again
     ticks_t now = g_clock.millis();
-    if(now - lastUpdate < 16)
-        return;
-    lastUpdate = now;
+    while(!m_animations.empty() && m_animations.top().time <= now) {
+        AnimatedTexturePtr animatedTexture = m_animations.top().texture;
+        m_animations.pop();
+
+        if(animatedTexture->isHidden()) {
+            animatedTexture->pause();
+            continue;
+        }
 
-    for(const AnimatedTexturePtr& animatedTexture : m_animatedTextures)
         animatedTexture->updateAnimation();
+        m_animations.push(ScheduledAnimation{animatedTexture->getNextFrameTime(), animatedTexture});
+        g_app.scheduleRepaint(0);
+    }
 }
 
 void TextureManager::clearCache()
 {
-    m_animatedTextures.clear();
+    m_textureLoads.clear();
+    m_loadCallbacks.clear();
+    m_animations = std::priority_queue<ScheduledAnimation>();
     m_textures.clear();
 }
 
@@ -75,6 +107,8 @@ void TextureManager::liveReload()
         for(auto& it : m_textures) {
             const std::string& path = g_resources.guessFilePath(it.first, "png");
             const TexturePtr& tex = it.second;
+            if(m_textureLoads.find(it.first) != m_textureLoads.end())
+                continue;
             if(tex->getTime() >= g_resources.getFileTime(path))
                 continue;
 
@@ -87,6 +121,17 @@ void TextureManager::liveReload()
     }, 1000);
 }
 
+void TextureManager::scheduleAnimation(const AnimatedTexturePtr& animatedTexture)
+{
+    m_animations.push(ScheduledAnimation{animatedTexture->getNextFrameTime(), animatedTexture});
+}
+
+void TextureManager::preloadAsync(const std::vector<std::string>& fileNames)
+{
+    for(const std::string& fileName : fileNames)
+        getTextureAsync(fileName);
+}
+
 TexturePtr TextureManager::getTexture(const std::string& fileName)
 {
     TexturePtr texture;
@@ -94,6 +139,19 @@ TexturePtr TextureManager::getTexture(const std::string& fileName)
     // before must resolve filename to full path
     std::string filePath = g_resources.resolvePath(fileName);
 
+    // a texture still being decoded in background must be finished now
+    auto loadIt = m_textureLoads.find(filePath);
+    if(loadIt != m_textureLoads.end()) {
+        TextureLoad load = loadIt->second;
+        m_textureLoads.erase(loadIt);
+        finishLoad(load);
+
+        std::vector<std::function<void()>> callbacks;
+        takeLoadCallbacks(load.texture, callbacks);
+        for(const std::function<void()>& callback : callbacks)
+            callback();
+    }
+
     // check if the texture is already loaded
     auto it = m_textures.find(filePath);
     if(it != m_textures.end()) {
@@ -142,7 +200,7 @@ TexturePtr TextureManager::loadTexture(std::stringstream& file)
                 frames.push_back(ImagePtr(new Image(imageSize, apng.bpp, frameData)));
             }
             AnimatedTexturePtr animatedTexture = new AnimatedTexture(imageSize, frames, framesDelay);
-            m_animatedTextures.push_back(animatedTexture);
+            scheduleAnimation(animatedTexture);
             texture = animatedTexture;
         } else {
             ImagePtr image = ImagePtr(new Image(imageSize, apng.bpp, apng.pdata));
@@ -153,3 +211,130 @@ TexturePtr TextureManager::loadTexture(std::stringstream& file)
 
     return texture;
 }
+
+TexturePtr TextureManager::getTextureAsync(const std::string& fileName)
+{
+    std::string filePath = g_resources.resolvePath(fileName);
+
+    auto it = m_textures.find(filePath);
+    if(it != m_textures.end())
+        return it->second;
+
+    // the file is read here, only the decoding is done by the async dispatcher
+    std::shared_ptr<std::string> fileData;
+    try {
+        std::string filePathEx = g_resources.guessFilePath(filePath, "png");
+        fileData = std::make_shared<std::string>(g_resources.readFileContents(filePathEx));
+    } catch(stdext::exception& e) {
+        g_logger.error(stdext::format("Unable to load texture '%s': %s", fileName, e.what()));
+        TexturePtr texture = g_textures.getEmptyTexture();
+        m_textures[filePath] = texture;
+        return texture;
+    }
+
+    // an empty placeholder is returned and receives the pixels when the decoding is done
+    TexturePtr texture;
+    if(isAnimatedPng(*fileData))
+        texture = AnimatedTexturePtr(new AnimatedTexture);
+    else
+        texture = TexturePtr(new Texture);
+    texture->setSmooth(true);
+    m_textures[filePath] = texture;
+
+    TextureLoad& load = m_textureLoads[filePath];
+    load.texture = texture;
+    load.fileName = fileName;
+    m_loadCallbacks[texture.get()];
+    load.data = g_asyncDispatcher.schedule([fileData]() -> TextureDataPtr {
+        TextureDataPtr data(new TextureData);
+        std::stringstream fin(*fileData);
+        apng_data apng;
+        if(load_apng(fin, &apng) != 0) {
+            data->error = "invalid png data";
+            return data;
+        }
+
+        data->size = Size(apng.width, apng.height);
+        data->bpp = apng.bpp;
+        int frameSize = data->size.area() * apng.bpp;
+        if(apng.num_frames > 1) {
+            for(uint i=0;i<apng.num_frames;++i) {
+                uchar *frameData = apng.pdata + ((apng.first_frame+i) * frameSize);
+                data->frames.push_back(std::vector<uint8>(frameData, frameData + frameSize));
+                data->framesDelay.push_back(apng.frames_delay[i]);
+            }
+        } else {
+            data->frames.push_back(std::vector<uint8>(apng.pdata, apng.pdata + frameSize));
+            data->framesDelay.push_back(0);
+        }
+        free_apng(&apng);
+        return data;
+    });
+
+    return texture;
+}
+
+void TextureManager::whenLoaded(const TexturePtr& texture, const std::function<void()>& callback)
+{
+    auto it = m_loadCallbacks.find(texture.get());
+    if(it != m_loadCallbacks.end())
+        it->second.push_back(callback);
+    else
+        callback();
+}
+
+void TextureManager::takeLoadCallbacks(const TexturePtr& texture, std::vector<std::function<void()>>& callbacks)
+{
+    auto it = m_loadCallbacks.find(texture.get());
+    if(it == m_loadCallbacks.end())
+        return;
+    callbacks.insert(callbacks.end(), it->second.begin(), it->second.end());
+    m_loadCallbacks.erase(it);
+}
+
+void TextureManager::uploadTextures()
+{
+    // callbacks may load more textures, so they run after the loads map is iterated
+    std::vector<std::function<void()>> callbacks;
+
+    // at least one texture is uploaded per poll
+    ticks_t startTime = stdext::micros();
+    for(auto it = m_textureLoads.begin(); it != m_textureLoads.end();) {
+        if(!it->second.data.is_ready()) {
+            ++it;
+            continue;
+        }
+
+        finishLoad(it->second);
+        takeLoadCallbacks(it->second.texture, callbacks);
+        it = m_textureLoads.erase(it);
+        g_app.repaint();
+
+        if(stdext::micros() - startTime >= TEXTURE_UPLOAD_BUDGET)
+            break;
+    }
+
+    for(const std::function<void()>& callback : callbacks)
+        callback();
+}
+
+void TextureManager::finishLoad(TextureLoad& load)
+{
+    const TexturePtr& texture = load.texture;
+    TextureDataPtr data = load.data.get();
+
+    // textures that failed to decode are left empty
+    if(!data->error.empty())
+        g_logger.error(stdext::format("Unable to load texture '%s': %s", load.fileName, data->error));
+    else if(texture->isAnimatedTexture()) {
+        std::vector<ImagePtr> frames;
+        for(std::vector<uint8>& pixels : data->frames)
+            frames.push_back(ImagePtr(new Image(data->size, data->bpp, pixels.data())));
+
+        AnimatedTexturePtr animatedTexture = texture->static_self_cast<AnimatedTexture>();
+        animatedTexture->setFrames(data->size, frames, data->framesDelay);
+        scheduleAnimation(animatedTexture);
+    } else
+        texture->uploadPixels(ImagePtr(new Image(data->size, data->bpp, data->frames[0].data())));
+    texture->setTime(stdext::time());
+}
@@ -25,9 +25,37 @@
 
 #include "texture.h"
 #include <framework/core/declarations.h>
+#include <framework/stdext/thread.h>
+
+#include <queue>
+
+struct TextureData {
+    Size size;
+    int bpp;
+    std::vector<std::vector<uint8>> frames;
+    std::vector<int> framesDelay;
+    std::string error; // decoding runs in the async dispatcher, errors are logged by the main thread
+};
+typedef std::shared_ptr<TextureData> TextureDataPtr;
 
 class TextureManager
 {
+    enum {
+        TEXTURE_UPLOAD_BUDGET = 4000
+    };
+
+    struct TextureLoad {
+        TexturePtr texture;
+        std::string fileName;
+        boost::shared_future<TextureDataPtr> data;
+    };
+
+    struct ScheduledAnimation {
+        ticks_t time;
+        AnimatedTexturePtr texture;
+        bool operator<(const ScheduledAnimation& other) const { return time > other.time; }
+    };
+
 public:
     void init();
     void terminate();
@@ -37,14 +65,27 @@ public:
     void liveReload();
 
     void preload(const std::string& fileName) { getTexture(fileName); }
+    void preloadAsync(const std::vector<std::string>& fileNames);
     TexturePtr getTexture(const std::string& fileName);
+    TexturePtr getTextureAsync(const std::string& fileName);
+    void whenLoaded(const TexturePtr& texture, const std::function<void()>& callback);
     const TexturePtr& getEmptyTexture() { return m_emptyTexture; }
+    int getPendingTextures() { return m_textureLoads.size(); }
+
+    void scheduleAnimation(const AnimatedTexturePtr& animatedTexture);
+    ticks_t getNextAnimationTime() { return m_animations.empty() ? -1 : m_animations.top().time; }
+    int getScheduledAnimations() { return m_animations.size(); }
 
 private:
     TexturePtr loadTexture(std::stringstream& file);
+    void uploadTextures();
+    void finishLoad(TextureLoad& load);
+    void takeLoadCallbacks(const TexturePtr& texture, std::vector<std::function<void()>>& callbacks);
 
     std::unordered_map<std::string, TexturePtr> m_textures;
-    std::vector<AnimatedTexturePtr> m_animatedTextures;
+    std::unordered_map<std::string, TextureLoad> m_textureLoads;
+    std::unordered_map<Texture*, std::vector<std::function<void()>>> m_loadCallbacks;
+    std::priority_queue<ScheduledAnimation> m_animations;
     TexturePtr m_emptyTexture;
     ScheduledEventPtr m_liveReloadEvent;
 };
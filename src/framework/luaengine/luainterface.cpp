@@ -24,6 +24,7 @@
 #include "luaobject.h"
 
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 #include <lua.hpp>
 
 #include "lbitlib.h"
@@ -37,6 +38,10 @@ LuaInterface::LuaInterface()
     m_weakTableRef = 0;
     m_totalObjRefs = 0;
     m_totalFuncRefs = 0;
+    m_gcStepSize = GARBAGE_MIN_STEP;
+    m_gcThreshold = 0;
+    m_gcLastMemory = 0;
+    resetGarbageStats();
 }
 
 LuaInterface::~LuaInterface()
@@ -432,6 +437,7 @@ std::string LuaInterface::getCurrentSourcePath(int level)
 int LuaInterface::safeCall(int numArgs, int numRets)
 {
     assert(hasIndex(-numArgs-1));
+    ProfilerZone zone("lua");
 
     // saves the current stack size for calculating the number of results later
     int previousStackSize = stackSize();
@@ -723,10 +729,102 @@ void LuaInterface::collectGarbage()
         for(int i=0;i<2;++i)
             lua_gc(L, LUA_GCCOLLECT, 0);
 
+        if(m_gcPaced) {
+            // a full collect restarts lua automatic collector
+            lua_gc(L, LUA_GCSTOP, 0);
+            m_gcCycleRunning = false;
+            m_gcLastMemory = getUsedMemory();
+            m_gcThreshold = (m_gcLastMemory * GARBAGE_PAUSE) / 100;
+        }
+
         collecting = false;
     }
 }
 
+void LuaInterface::setGarbageCollectorPaced(bool paced)
+{
+    if(m_gcPaced == paced)
+        return;
+
+    m_gcPaced = paced;
+    if(!L)
+        return;
+
+    if(paced) {
+        lua_gc(L, LUA_GCSTOP, 0);
+        m_gcCycleRunning = false;
+        m_gcLastMemory = getUsedMemory();
+        m_gcThreshold = (m_gcLastMemory * GARBAGE_PAUSE) / 100;
+    } else
+        lua_gc(L, LUA_GCRESTART, 0);
+}
+
+ticks_t LuaInterface::stepGarbageCollector(ticks_t maxMicros)
+{
+    if(!L || !m_gcPaced)
+        return 0;
+
+    int usedMemory = getUsedMemory();
+    int allocated = std::max<int>(usedMemory - m_gcLastMemory, 0);
+    m_gcLastMemory = usedMemory;
+
+    // between cycles there is nothing to do until the memory grows enough
+    if(!m_gcCycleRunning) {
+        if(usedMemory < m_gcThreshold)
+            return 0;
+        m_gcCycleRunning = true;
+    }
+
+    // collect at least what was allocated since the last frame, otherwise the collector
+    // could never finish a cycle while scripts allocate faster than it sweeps
+    m_gcStepSize = stdext::clamp<int>(allocated, GARBAGE_MIN_STEP, GARBAGE_MAX_STEP);
+
+    ticks_t start = stdext::micros();
+    ticks_t elapsed = 0;
+    ticks_t stepMicros = 0;
+    do {
+        // lua_gc returns 1 when the step finished a collection cycle
+        bool finished = lua_gc(L, LUA_GCSTEP, m_gcStepSize) == 1;
+        ticks_t now = stdext::micros();
+        stepMicros = now - start - elapsed;
+        elapsed = now - start;
+
+        if(finished) {
+            m_gcCycleRunning = false;
+            m_gcCycles++;
+            break;
+        }
+    // only keep stepping while the next step is expected to fit in the remaining budget
+    } while(elapsed + stepMicros <= maxMicros);
+
+    // lua 5.1 step rearms the automatic collector, so stop it again
+    lua_gc(L, LUA_GCSTOP, 0);
+
+    m_gcLastMemory = getUsedMemory();
+    if(!m_gcCycleRunning)
+        m_gcThreshold = (m_gcLastMemory * GARBAGE_PAUSE) / 100;
+
+    m_gcLastPause = elapsed;
+    m_gcMaxPause = std::max<ticks_t>(m_gcMaxPause, elapsed);
+    m_gcTotalTime += elapsed;
+    return elapsed;
+}
+
+int LuaInterface::getUsedMemory()
+{
+    if(!L)
+        return 0;
+    return lua_gc(L, LUA_GCCOUNT, 0);
+}
+
+void LuaInterface::resetGarbageStats()
+{
+    m_gcCycles = 0;
+    m_gcLastPause = 0;
+    m_gcMaxPause = 0;
+    m_gcTotalTime = 0;
+}
+
 void LuaInterface::loadBuffer(const std::string& buffer, const std::string& source)
 {
     // loads lua buffer
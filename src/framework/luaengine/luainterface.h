@@ -31,6 +31,12 @@ typedef int (*LuaCFunction) (lua_State *L);
 /// Class that manages LUA stuff
 class LuaInterface
 {
+    enum {
+        GARBAGE_MIN_STEP = 8, // kilobytes
+        GARBAGE_MAX_STEP = 1024,
+        GARBAGE_PAUSE = 200 // wait memory to double before starting a new cycle, like lua default
+    };
+
 public:
     LuaInterface();
     ~LuaInterface();
@@ -221,6 +227,26 @@ public:
 
     void collectGarbage();
 
+    /// Enables or disables frame paced garbage collection, when enabled lua automatic
+    /// collector is stopped and garbage is only collected by stepGarbageCollector
+    void setGarbageCollectorPaced(bool paced);
+    bool isGarbageCollectorPaced() { return m_gcPaced; }
+
+    /// Runs incremental garbage collection steps until the time budget is spent,
+    /// the step size follows the memory allocated by scripts since the last call
+    /// @param maxMicros is the idle frame time that can be spent collecting
+    /// @return the time spent collecting in microseconds
+    ticks_t stepGarbageCollector(ticks_t maxMicros);
+
+    /// Memory in use by lua in kilobytes
+    int getUsedMemory();
+    int getGarbageStepSize() { return m_gcStepSize; }
+    int getGarbageCycles() { return m_gcCycles; }
+    ticks_t getGarbageLastPause() { return m_gcLastPause; }
+    ticks_t getGarbageMaxPause() { return m_gcMaxPause; }
+    ticks_t getGarbageTotalTime() { return m_gcTotalTime; }
+    void resetGarbageStats();
+
     void loadBuffer(const std::string& buffer, const std::string& source);
 
     int pcall(int numArgs = 0, int numRets = 0, int errorFuncIndex = 0);
@@ -345,6 +371,15 @@ private:
     int m_totalObjRefs;
     int m_totalFuncRefs;
     int m_globalEnv;
+    stdext::boolean<false> m_gcPaced;
+    stdext::boolean<false> m_gcCycleRunning;
+    int m_gcStepSize;
+    int m_gcThreshold;
+    int m_gcLastMemory;
+    int m_gcCycles;
+    ticks_t m_gcLastPause;
+    ticks_t m_gcMaxPause;
+    ticks_t m_gcTotalTime;
 };
 
 extern LuaInterface g_lua;
@@ -30,6 +30,7 @@
 #include <framework/core/module.h>
 #include <framework/util/crypt.h>
 #include <framework/core/resourcemanager.h>
+#include <framework/core/profiler.h>
 #include <framework/graphics/texturemanager.h>
 #include <framework/stdext/net.h>
 #include <framework/platform/platform.h>
@@ -130,6 +131,16 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_clock", "millis", &Clock::millis, &g_clock);
     g_lua.bindSingletonFunction("g_clock", "seconds", &Clock::seconds, &g_clock);
 
+    // Profiler
+    g_lua.registerSingletonClass("g_profiler");
+    g_lua.bindSingletonFunction("g_profiler", "setEnabled", &Profiler::setEnabled, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "setOverlayVisible", &Profiler::setOverlayVisible, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "isEnabled", &Profiler::isEnabled, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "isOverlayVisible", &Profiler::isOverlayVisible, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "clear", &Profiler::clear, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "getReport", &Profiler::getReport, &g_profiler);
+    g_lua.bindSingletonFunction("g_profiler", "exportTrace", &Profiler::exportTrace, &g_profiler);
+
     // ConfigManager
     g_lua.registerSingletonClass("g_configs");
     g_lua.bindSingletonFunction("g_configs", "getSettings", &ConfigManager::getSettings, &g_configs);
@@ -248,10 +259,24 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_app", "setForegroundPaneMaxFps", &GraphicalApplication::setForegroundPaneMaxFps, &g_app);
     g_lua.bindSingletonFunction("g_app", "setBackgroundPaneMaxFps", &GraphicalApplication::setBackgroundPaneMaxFps, &g_app);
     g_lua.bindSingletonFunction("g_app", "isOnInputEvent", &GraphicalApplication::isOnInputEvent, &g_app);
+    g_lua.bindSingletonFunction("g_app", "setDamageTracking", &GraphicalApplication::setDamageTracking, &g_app);
+    g_lua.bindSingletonFunction("g_app", "isDamageTracking", &GraphicalApplication::isDamageTracking, &g_app);
+    g_lua.bindSingletonFunction("g_app", "repaint", &GraphicalApplication::repaint, &g_app);
+    g_lua.bindSingletonFunction("g_app", "repaintBackground", &GraphicalApplication::repaintBackground, &g_app);
+    g_lua.bindSingletonFunction("g_app", "getRenderedFrames", &GraphicalApplication::getRenderedFrames, &g_app);
+    g_lua.bindSingletonFunction("g_app", "getSkippedFrames", &GraphicalApplication::getSkippedFrames, &g_app);
+    g_lua.bindSingletonFunction("g_app", "resetFrameStats", &GraphicalApplication::resetFrameStats, &g_app);
     g_lua.bindSingletonFunction("g_app", "getForegroundPaneFps", &GraphicalApplication::getForegroundPaneFps, &g_app);
     g_lua.bindSingletonFunction("g_app", "getBackgroundPaneFps", &GraphicalApplication::getBackgroundPaneFps, &g_app);
     g_lua.bindSingletonFunction("g_app", "getForegroundPaneMaxFps", &GraphicalApplication::getForegroundPaneMaxFps, &g_app);
     g_lua.bindSingletonFunction("g_app", "getBackgroundPaneMaxFps", &GraphicalApplication::getBackgroundPaneMaxFps, &g_app);
+    g_lua.bindSingletonFunction("g_app", "getLuaUsedMemory", &LuaInterface::getUsedMemory, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "getLuaGarbageStepSize", &LuaInterface::getGarbageStepSize, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "getLuaGarbageCycles", &LuaInterface::getGarbageCycles, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "getLuaGarbageLastPause", &LuaInterface::getGarbageLastPause, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "getLuaGarbageMaxPause", &LuaInterface::getGarbageMaxPause, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "getLuaGarbageTotalTime", &LuaInterface::getGarbageTotalTime, &g_lua);
+    g_lua.bindSingletonFunction("g_app", "resetLuaGarbageStats", &LuaInterface::resetGarbageStats, &g_lua);
 
     // PlatformWindow
     g_lua.registerSingletonClass("g_window");
@@ -319,6 +344,9 @@ void Application::registerLuaFunctions()
     // Textures
     g_lua.registerSingletonClass("g_textures");
     g_lua.bindSingletonFunction("g_textures", "preload", &TextureManager::preload, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "preloadAsync", &TextureManager::preloadAsync, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getPendingTextures", &TextureManager::getPendingTextures, &g_textures);
+    g_lua.bindSingletonFunction("g_textures", "getScheduledAnimations", &TextureManager::getScheduledAnimations, &g_textures);
     g_lua.bindSingletonFunction("g_textures", "clearCache", &TextureManager::clearCache, &g_textures);
     g_lua.bindSingletonFunction("g_textures", "liveReload", &TextureManager::liveReload, &g_textures);
 
@@ -339,6 +367,8 @@ void Application::registerLuaFunctions()
     g_lua.bindSingletonFunction("g_ui", "isDrawingDebugBoxes", &UIManager::isDrawingDebugBoxes, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "isMouseGrabbed", &UIManager::isMouseGrabbed, &g_ui);
     g_lua.bindSingletonFunction("g_ui", "isKeyboardGrabbed", &UIManager::isKeyboardGrabbed, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getLayoutUpdates", &UIManager::getLayoutUpdates, &g_ui);
+    g_lua.bindSingletonFunction("g_ui", "getLayoutWidgets", &UIManager::getLayoutWidgets, &g_ui);
 
     // FontManager
     g_lua.registerSingletonClass("g_fonts");
@@ -490,6 +520,7 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIWidget>("setBackgroundSize", &UIWidget::setBackgroundSize);
     g_lua.bindClassMemberFunction<UIWidget>("setBackgroundRect", &UIWidget::setBackgroundRect);
     g_lua.bindClassMemberFunction<UIWidget>("setIcon", &UIWidget::setIcon);
+    g_lua.bindClassMemberFunction<UIWidget>("setIconAsync", &UIWidget::setIconAsync);
     g_lua.bindClassMemberFunction<UIWidget>("setIconColor", &UIWidget::setIconColor);
     g_lua.bindClassMemberFunction<UIWidget>("setIconOffsetX", &UIWidget::setIconOffsetX);
     g_lua.bindClassMemberFunction<UIWidget>("setIconOffsetY", &UIWidget::setIconOffsetY);
@@ -571,6 +602,7 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<UIWidget>("getOpacity", &UIWidget::getOpacity);
     g_lua.bindClassMemberFunction<UIWidget>("getRotation", &UIWidget::getRotation);
     g_lua.bindClassMemberFunction<UIWidget>("setImageSource", &UIWidget::setImageSource);
+    g_lua.bindClassMemberFunction<UIWidget>("setImageSourceAsync", &UIWidget::setImageSourceAsync);
     g_lua.bindClassMemberFunction<UIWidget>("setImageClip", &UIWidget::setImageClip);
     g_lua.bindClassMemberFunction<UIWidget>("setImageOffsetX", &UIWidget::setImageOffsetX);
     g_lua.bindClassMemberFunction<UIWidget>("setImageOffsetY", &UIWidget::setImageOffsetY);
@@ -760,6 +792,12 @@ void Application::registerLuaFunctions()
     // Connection
     g_lua.registerClass<Connection>();
     g_lua.bindClassMemberFunction<Connection>("getIp", &Connection::getIp);
+    g_lua.bindClassMemberFunction<Connection>("setWriteDelay", &Connection::setWriteDelay);
+    g_lua.bindClassMemberFunction<Connection>("getWriteDelay", &Connection::getWriteDelay);
+    g_lua.bindClassMemberFunction<Connection>("getBytesWritten", &Connection::getBytesWritten);
+    g_lua.bindClassMemberFunction<Connection>("getMessagesWritten", &Connection::getMessagesWritten);
+    g_lua.bindClassMemberFunction<Connection>("getSocketWrites", &Connection::getSocketWrites);
+    g_lua.bindClassMemberFunction<Connection>("getCoalescingRatio", &Connection::getCoalescingRatio);
 
     // Protocol
     g_lua.registerClass<Protocol>();
@@ -771,6 +809,7 @@ void Application::registerLuaFunctions()
     g_lua.bindClassMemberFunction<Protocol>("getConnection", &Protocol::getConnection);
     g_lua.bindClassMemberFunction<Protocol>("setConnection", &Protocol::setConnection);
     g_lua.bindClassMemberFunction<Protocol>("send", &Protocol::send);
+    g_lua.bindClassMemberFunction<Protocol>("flush", &Protocol::flush);
     g_lua.bindClassMemberFunction<Protocol>("recv", &Protocol::recv);
     g_lua.bindClassMemberFunction<Protocol>("setXteaKey", &Protocol::setXteaKey);
     g_lua.bindClassMemberFunction<Protocol>("getXteaKey", &Protocol::getXteaKey);
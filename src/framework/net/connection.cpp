@@ -29,7 +29,7 @@
 #include <memory>
 
 asio::io_service g_ioService;
-std::list<std::shared_ptr<asio::streambuf>> Connection::m_outputStreams;
+std::vector<Connection::WriteBufferPtr> Connection::m_writeBuffersPool;
 
 Connection::Connection() :
         m_readTimer(g_ioService),
@@ -40,6 +40,14 @@ Connection::Connection() :
 {
     m_connected = false;
     m_connecting = false;
+    m_writing = false;
+    m_closing = false;
+    m_flushPending = false;
+    m_delayedWritePending = false;
+    m_writeDelay = 0;
+    m_bytesWritten = 0;
+    m_messagesWritten = 0;
+    m_socketWrites = 0;
 }
 
 Connection::~Connection()
@@ -50,17 +58,17 @@ Connection::~Connection()
     close();
 }
 
-void Connection::poll()
+int Connection::poll()
 {
     // reset must always be called prior to poll
     g_ioService.reset();
-    g_ioService.poll();
+    return g_ioService.poll();
 }
 
 void Connection::terminate()
 {
     g_ioService.stop();
-    m_outputStreams.clear();
+    m_writeBuffersPool.clear();
 }
 
 void Connection::close()
@@ -68,8 +76,10 @@ void Connection::close()
     if(!m_connected && !m_connecting)
         return;
 
-    // flush send data before disconnecting on clean connections
-    if(m_connected && !m_error && m_outputStream)
+    // flush send data before disconnecting on clean connections,
+    // a write in flight sends the pending data itself when it completes
+    bool flushing = m_connected && !m_error && (m_writing || !m_pendingWrites.empty());
+    if(flushing && !m_writing)
         internal_write();
 
     m_connecting = false;
@@ -80,9 +90,22 @@ void Connection::close()
 
     m_resolver.cancel();
     m_readTimer.cancel();
-    m_writeTimer.cancel();
     m_delayedWriteTimer.cancel();
 
+    // the socket is closed by onWrite once everything is written, the write timer still guards it
+    if(flushing) {
+        m_closing = true;
+        return;
+    }
+
+    internal_close();
+}
+
+void Connection::internal_close()
+{
+    m_closing = false;
+    m_writeTimer.cancel();
+
     if(m_socket.is_open()) {
         boost::system::error_code ec;
         m_socket.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
@@ -92,6 +115,10 @@ void Connection::close()
 
 void Connection::connect(const std::string& host, uint16 port, const std::function<void()>& connectCallback)
 {
+    // a previous connection still flushing its data is dropped
+    if(m_closing)
+        internal_close();
+
     m_connected = false;
     m_connecting = true;
     m_error.clear();
@@ -127,36 +154,65 @@ void Connection::write(uint8* buffer, size_t size)
     if(!m_connected)
         return;
 
-    // we can't send the data right away, otherwise we could create tcp congestion
-    if(!m_outputStream) {
-        if(!m_outputStreams.empty()) {
-            m_outputStream = m_outputStreams.front();
-            m_outputStreams.pop_front();
-        } else
-            m_outputStream = std::make_shared<asio::streambuf>();
+    WriteBufferPtr writeBuffer;
+    if(!m_writeBuffersPool.empty()) {
+        writeBuffer = m_writeBuffersPool.back();
+        m_writeBuffersPool.pop_back();
+    } else
+        writeBuffer = std::make_shared<std::vector<uint8>>();
+    writeBuffer->assign(buffer, buffer + size);
+    m_pendingWrites.push_back(writeBuffer);
 
+    // we can't send the data right away, otherwise we could create tcp congestion
+    if(!m_delayedWritePending && !m_flushPending) {
+        m_delayedWritePending = true;
         m_delayedWriteTimer.cancel();
-        m_delayedWriteTimer.expires_from_now(boost::posix_time::milliseconds(0));
+        m_delayedWriteTimer.expires_from_now(boost::posix_time::milliseconds(m_writeDelay));
         m_delayedWriteTimer.async_wait([connection = asConnection()] (auto error) {
             connection->onCanWrite(error);
         });
     }
+}
+
+void Connection::flush()
+{
+    if(!m_connected || m_pendingWrites.empty())
+        return;
+
+    if(m_delayedWritePending) {
+        m_delayedWritePending = false;
+        m_delayedWriteTimer.cancel();
+    }
 
-    std::ostream os(m_outputStream.get());
-    os.write((const char*)buffer, size);
-    os.flush();
+    // when a write is in flight the pending data is sent as soon as it completes
+    m_flushPending = true;
+    if(!m_writing)
+        internal_write();
 }
 
 void Connection::internal_write()
 {
-    if(!m_connected)
+    if(!m_connected && !m_closing)
         return;
 
-    std::shared_ptr<asio::streambuf> outputStream = m_outputStream;
-    m_outputStream = nullptr;
+    m_flushPending = false;
+
+    // all pending messages are gathered into a single socket write
+    std::vector<asio::const_buffer> buffers;
+    buffers.reserve(m_pendingWrites.size());
+    for(const WriteBufferPtr& writeBuffer : m_pendingWrites) {
+        buffers.push_back(asio::buffer(*writeBuffer));
+        m_bytesWritten += writeBuffer->size();
+    }
+    m_messagesWritten += m_pendingWrites.size();
+    m_socketWrites++;
+
+    m_inflightWrites.insert(m_inflightWrites.end(), m_pendingWrites.begin(), m_pendingWrites.end());
+    m_pendingWrites.clear();
+    m_writing = true;
 
-    asio::async_write(m_socket, *outputStream, [connection = asConnection(), outputStream] (auto error, auto size) {
-        connection->onWrite(error, size, outputStream);
+    asio::async_write(m_socket, buffers, [connection = asConnection()] (auto error, auto size) {
+        connection->onWrite(error, size);
     });
 
     m_writeTimer.cancel();
@@ -220,6 +276,25 @@ void Connection::read_some(const RecvCallback& callback)
     });
 }
 
+void Connection::read_some(uint8* buffer, uint16 size, const RecvCallback& callback)
+{
+    if(!m_connected)
+        return;
+
+    m_recvCallback = callback;
+
+    // reads directly into the caller buffer, skipping the input stream copy
+    m_socket.async_read_some(asio::buffer(buffer, size), [connection = asConnection(), buffer] (auto error, auto size) {
+        connection->onRecv(error, size, buffer);
+    });
+
+    m_readTimer.cancel();
+    m_readTimer.expires_from_now(boost::posix_time::seconds(static_cast<uint32>(READ_TIMEOUT)));
+    m_readTimer.async_wait([connection = asConnection()] (auto error) {
+        connection->onTimeout(error);
+    });
+}
+
 void Connection::onResolve(const boost::system::error_code& error, asio::ip::basic_resolver<asio::ip::tcp>::iterator endpointIterator)
 {
     m_readTimer.cancel();
@@ -258,31 +333,41 @@ void Connection::onConnect(const boost::system::error_code& error)
 
 void Connection::onCanWrite(const boost::system::error_code& error)
 {
-    m_delayedWriteTimer.cancel();
-
     if(error == asio::error::operation_aborted)
         return;
 
-    if(m_connected)
-        internal_write();
+    m_delayedWritePending = false;
+    flush();
 }
 
-void Connection::onWrite(const boost::system::error_code& error, size_t writeSize, std::shared_ptr<asio::streambuf> outputStream)
+void Connection::onWrite(const boost::system::error_code& error, size_t writeSize)
 {
     m_writeTimer.cancel();
 
     if(error == asio::error::operation_aborted)
         return;
 
-    // free output stream and store for using it again later
-    outputStream->consume(outputStream->size());
-    m_outputStreams.push_back(outputStream);
+    // free write buffers and store for using them again later
+    for(const WriteBufferPtr& writeBuffer : m_inflightWrites) {
+        writeBuffer->clear();
+        m_writeBuffersPool.push_back(writeBuffer);
+    }
+    m_inflightWrites.clear();
+    m_writing = false;
 
-    if(m_connected && error)
+    if(m_connected && error) {
         handleError(error);
+        return;
+    }
+
+    // data flushed while this write was in flight, or left behind by close
+    if((m_flushPending || m_closing) && !m_pendingWrites.empty() && !error)
+        internal_write();
+    else if(m_closing)
+        internal_close();
 }
 
-void Connection::onRecv(const boost::system::error_code& error, size_t recvSize)
+void Connection::onRecv(const boost::system::error_code& error, size_t recvSize, uint8* recvBuffer)
 {
     m_readTimer.cancel();
     m_activityTimer.restart();
@@ -293,14 +378,16 @@ void Connection::onRecv(const boost::system::error_code& error, size_t recvSize)
     if(m_connected) {
         if(!error) {
             if(m_recvCallback) {
-                const char* header = boost::asio::buffer_cast<const char*>(m_inputStream.data());
-                m_recvCallback((uint8*)header, recvSize);
+                uint8* buffer = recvBuffer;
+                if(!buffer)
+                    buffer = (uint8*)boost::asio::buffer_cast<const char*>(m_inputStream.data());
+                m_recvCallback(buffer, recvSize);
             }
         } else
             handleError(error);
     }
 
-    if(!error)
+    if(!error && !recvBuffer)
         m_inputStream.consume(recvSize);
 }
 
@@ -322,6 +409,8 @@ void Connection::handleError(const boost::system::error_code& error)
         m_errorCallback(error);
     if(m_connected || m_connecting)
         close();
+    else if(m_closing)
+        internal_close();
 }
 
 int Connection::getIp()
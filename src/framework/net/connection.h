@@ -32,6 +32,7 @@ class Connection : public LuaObject
 {
     typedef std::function<void(const boost::system::error_code&)> ErrorCallback;
     typedef std::function<void(uint8*, uint16)> RecvCallback;
+    typedef std::shared_ptr<std::vector<uint8>> WriteBufferPtr;
 
     enum {
         READ_TIMEOUT = 30,
@@ -44,19 +45,31 @@ public:
     Connection();
     ~Connection();
 
-    static void poll();
+    static int poll();
     static void terminate();
 
     void connect(const std::string& host, uint16 port, const std::function<void()>& connectCallback);
     void close();
 
     void write(uint8* buffer, size_t size);
+    void flush();
     void read(uint16 bytes, const RecvCallback& callback);
     void read_until(const std::string& what, const RecvCallback& callback);
     void read_some(const RecvCallback& callback);
+    void read_some(uint8* buffer, uint16 size, const RecvCallback& callback);
 
     void setErrorCallback(const ErrorCallback& errorCallback) { m_errorCallback = errorCallback; }
 
+    /// Time in milliseconds that written data waits to be coalesced with following writes,
+    /// 0 means everything written in the same poll cycle is sent together
+    void setWriteDelay(int delay) { m_writeDelay = std::max<int>(delay, 0); }
+    int getWriteDelay() { return m_writeDelay; }
+
+    uint64 getBytesWritten() { return m_bytesWritten; }
+    uint32 getMessagesWritten() { return m_messagesWritten; }
+    uint32 getSocketWrites() { return m_socketWrites; }
+    float getCoalescingRatio() { return m_socketWrites > 0 ? m_messagesWritten / (float)m_socketWrites : 0.0f; }
+
     int getIp();
     boost::system::error_code getError() { return m_error; }
     bool isConnecting() { return m_connecting; }
@@ -68,11 +81,12 @@ public:
 protected:
     void internal_connect(asio::ip::basic_resolver<asio::ip::tcp>::iterator endpointIterator);
     void internal_write();
+    void internal_close();
     void onResolve(const boost::system::error_code& error, asio::ip::tcp::resolver::iterator endpointIterator);
     void onConnect(const boost::system::error_code& error);
     void onCanWrite(const boost::system::error_code& error);
-    void onWrite(const boost::system::error_code& error, size_t writeSize, std::shared_ptr<asio::streambuf> outputStream);
-    void onRecv(const boost::system::error_code& error, size_t recvSize);
+    void onWrite(const boost::system::error_code& error, size_t writeSize);
+    void onRecv(const boost::system::error_code& error, size_t recvSize, uint8* recvBuffer = nullptr);
     void onTimeout(const boost::system::error_code& error);
     void handleError(const boost::system::error_code& error);
 
@@ -86,11 +100,20 @@ protected:
     asio::ip::tcp::resolver m_resolver;
     asio::ip::tcp::socket m_socket;
 
-    static std::list<std::shared_ptr<asio::streambuf>> m_outputStreams;
-    std::shared_ptr<asio::streambuf> m_outputStream;
+    static std::vector<WriteBufferPtr> m_writeBuffersPool;
+    std::vector<WriteBufferPtr> m_pendingWrites;
+    std::vector<WriteBufferPtr> m_inflightWrites;
     asio::streambuf m_inputStream;
     bool m_connected;
     bool m_connecting;
+    bool m_writing;
+    bool m_closing;
+    bool m_flushPending;
+    bool m_delayedWritePending;
+    int m_writeDelay;
+    uint64 m_bytesWritten;
+    uint32 m_messagesWritten;
+    uint32 m_socketWrites;
     boost::system::error_code m_error;
     stdext::timer m_activityTimer;
 
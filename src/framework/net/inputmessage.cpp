@@ -26,6 +26,7 @@
 InputMessage::InputMessage()
 {
     reset();
+    clearRecvBuffer();
 }
 
 void InputMessage::reset()
@@ -100,18 +101,46 @@ bool InputMessage::decryptRsa(int size)
     return (getU8() == 0x00);
 }
 
-void InputMessage::fillBuffer(uint8 *buffer, uint16 size)
+void InputMessage::fillBuffer(uint8 *buffer, int size)
 {
     checkWrite(m_readPos + size);
     memcpy(m_buffer + m_readPos, buffer, size);
     m_messageSize += size;
 }
 
-void InputMessage::setHeaderSize(uint16 size)
+bool InputMessage::hasOversizedPacket()
 {
-    assert(MAX_HEADER_SIZE - size >= 0);
-    m_headerPos = MAX_HEADER_SIZE - size;
-    m_readPos = m_headerPos;
+    if(m_recvSize - m_recvPos < 2)
+        return false;
+    return stdext::readULE16(m_buffer + m_recvPos) + 2 > BUFFER_MAXSIZE;
+}
+
+bool InputMessage::nextPacket()
+{
+    int available = m_recvSize - m_recvPos;
+    if(available < 2)
+        return false;
+
+    // the first 2 bytes of every packet contain the size of the remaining data
+    int packetSize = stdext::readULE16(m_buffer + m_recvPos) + 2;
+    if(available < packetSize)
+        return false;
+
+    m_headerPos = m_recvPos;
+    m_readPos = m_recvPos;
+    m_messageSize = packetSize;
+    m_recvPos += packetSize;
+    return true;
+}
+
+void InputMessage::compactRecvBuffer()
+{
+    // move the incomplete packet tail to the buffer start, so the next read can append to it
+    int remaining = m_recvSize - m_recvPos;
+    if(m_recvPos > 0 && remaining > 0)
+        memmove(m_buffer, m_buffer + m_recvPos, remaining);
+    m_recvPos = 0;
+    m_recvSize = remaining;
 }
 
 bool InputMessage::readChecksum()
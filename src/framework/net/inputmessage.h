@@ -40,8 +40,8 @@ public:
     void setBuffer(const std::string& buffer);
     std::string getBuffer() { return std::string((char*)m_buffer + m_headerPos, m_messageSize); }
 
-    void skipBytes(uint16 bytes) { m_readPos += bytes; }
-    void setReadPos(uint16 readPos) { m_readPos = readPos; }
+    void skipBytes(int bytes) { m_readPos += bytes; }
+    void setReadPos(int readPos) { m_readPos = readPos; }
     uint8 getU8();
     uint16 getU16();
     uint32 getU32();
@@ -59,21 +59,29 @@ public:
     int getReadSize() { return m_readPos - m_headerPos; }
     int getReadPos() { return m_readPos; }
     int getUnreadSize() { return m_messageSize - (m_readPos - m_headerPos); }
-    uint16 getMessageSize() { return m_messageSize; }
+    int getMessageSize() { return m_messageSize; }
 
     bool eof() { return (m_readPos - m_headerPos) >= m_messageSize; }
 
 protected:
     void reset();
-    void fillBuffer(uint8 *buffer, uint16 size);
+    void fillBuffer(uint8 *buffer, int size);
 
-    void setHeaderSize(uint16 size);
-    void setMessageSize(uint16 size) { m_messageSize = size; }
+    void setMessageSize(int size) { m_messageSize = size; }
+
+    // socket data is received straight into the message buffer,
+    // then each framed packet in it is parsed in place
+    uint8* getRecvBuffer() { return m_buffer + m_recvSize; }
+    int getRecvFreeSize() { return BUFFER_MAXSIZE - m_recvSize; }
+    void addRecvSize(int size) { m_recvSize += size; }
+    bool hasOversizedPacket();
+    bool nextPacket();
+    void compactRecvBuffer();
+    void clearRecvBuffer() { m_recvPos = 0; m_recvSize = 0; }
 
     uint8* getReadBuffer() { return m_buffer + m_readPos; }
     uint8* getHeaderBuffer() { return m_buffer + m_headerPos; }
     uint8* getDataBuffer() { return m_buffer + MAX_HEADER_SIZE; }
-    uint16 getHeaderSize() { return (MAX_HEADER_SIZE - m_headerPos); }
 
     uint16 readSize() { return getU16(); }
     bool readChecksum();
@@ -85,9 +93,12 @@ private:
     void checkRead(int bytes);
     void checkWrite(int bytes);
 
-    uint16 m_headerPos;
-    uint16 m_readPos;
-    uint16 m_messageSize;
+    // packets are parsed in place anywhere in the buffer, a packet can end at BUFFER_MAXSIZE
+    int m_headerPos;
+    int m_readPos;
+    int m_messageSize;
+    int m_recvPos;
+    int m_recvSize;
     uint8 m_buffer[BUFFER_MAXSIZE];
 };
 
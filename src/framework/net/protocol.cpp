@@ -25,10 +25,18 @@
 #include <framework/core/application.h>
 #include <random>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XTEA_SSE2
+#endif
+
 Protocol::Protocol()
 {
     m_xteaEncryptionEnabled = false;
     m_checksumEnabled = false;
+    m_recvRequested = false;
+    m_reading = false;
+    m_dispatching = false;
     m_inputMessage = InputMessagePtr(new InputMessage);
 }
 
@@ -42,6 +50,10 @@ Protocol::~Protocol()
 
 void Protocol::connect(const std::string& host, uint16 port)
 {
+    m_recvRequested = false;
+    m_reading = false;
+    m_inputMessage->clearRecvBuffer();
+
     m_connection = ConnectionPtr(new Connection);
     m_connection->setErrorCallback([proto = asProtocol()] (auto error) {
         proto->onError(error);
@@ -94,47 +106,68 @@ void Protocol::send(const OutputMessagePtr& outputMessage)
     outputMessage->reset();
 }
 
-void Protocol::recv()
+void Protocol::flush()
 {
-    m_inputMessage->reset();
-
-    // first update message header size
-    int headerSize = 2; // 2 bytes for message size
-    if(m_checksumEnabled)
-        headerSize += 4; // 4 bytes for checksum
-    if(m_xteaEncryptionEnabled)
-        headerSize += 2; // 2 bytes for XTEA encrypted message size
-    m_inputMessage->setHeaderSize(headerSize);
-
-    // read the first 2 bytes which contain the message size
+    // sends queued messages right away instead of waiting to coalesce them
     if(m_connection)
-        m_connection->read(2, [proto = asProtocol()] (auto buffer, auto size) {
-            proto->internalRecvHeader(buffer, size);
-        });
+        m_connection->flush();
 }
 
-void Protocol::internalRecvHeader(uint8* buffer, uint16 size)
+void Protocol::recv()
 {
-    // read message size
-    m_inputMessage->fillBuffer(buffer, size);
-    uint16 remainingSize = m_inputMessage->readSize();
+    m_recvRequested = true;
 
-    // read remaining message data
-    if(m_connection)
-        m_connection->read(remainingSize, [proto = asProtocol()] (auto buffer, auto size) {
-            proto->internalRecvData(buffer, size);
-        });
+    // when called from onRecv the dispatch loop delivers the next buffered packet
+    if(!m_dispatching)
+        internalDispatchPackets();
 }
 
 void Protocol::internalRecvData(uint8* buffer, uint16 size)
 {
+    m_reading = false;
+
     // process data only if really connected
     if(!isConnected()) {
         g_logger.traceError("received data while disconnected");
         return;
     }
 
-    m_inputMessage->fillBuffer(buffer, size);
+    // data was read in place into the input message buffer
+    m_inputMessage->addRecvSize(size);
+    internalDispatchPackets();
+}
+
+void Protocol::internalDispatchPackets()
+{
+    // a single read may contain many packets, they are all dispatched before reading again
+    m_dispatching = true;
+    while(m_recvRequested && isConnected() && m_inputMessage->nextPacket()) {
+        m_recvRequested = false;
+        internalRecvPacket();
+    }
+    m_dispatching = false;
+
+    if(!m_recvRequested || m_reading || !isConnected())
+        return;
+
+    if(m_inputMessage->hasOversizedPacket()) {
+        g_logger.traceError("got a network message bigger than the input buffer");
+        onError(asio::error::message_size);
+        return;
+    }
+
+    m_inputMessage->compactRecvBuffer();
+
+    m_reading = true;
+    m_connection->read_some(m_inputMessage->getRecvBuffer(), std::min<int>(m_inputMessage->getRecvFreeSize(), std::numeric_limits<uint16>::max()), [proto = asProtocol()] (auto buffer, auto size) {
+        proto->internalRecvData(buffer, size);
+    });
+}
+
+void Protocol::internalRecvPacket()
+{
+    // skip message size
+    m_inputMessage->readSize();
 
     if(m_checksumEnabled && !m_inputMessage->readChecksum()) {
         g_logger.traceError("got a network message with invalid checksum");
@@ -160,43 +193,128 @@ void Protocol::generateXteaKey()
 namespace {
 
 constexpr uint32_t delta = 0x9E3779B9;
+constexpr int rounds = 32;
+
+// the key and the round sum only depend on the round, so they are added once for all blocks
+struct RoundKeys {
+    RoundKeys(const std::array<uint32, 4>& key, bool decrypt) {
+        for(int i = 0; i < rounds; ++i) {
+            if(decrypt) {
+                uint32_t sum = delta * (rounds - i), next_sum = sum - delta;
+                first[i] = sum + key[(sum >> 11) & 3];
+                second[i] = next_sum + key[next_sum & 3];
+            } else {
+                uint32_t sum = delta * i, next_sum = sum + delta;
+                first[i] = sum + key[sum & 3];
+                second[i] = next_sum + key[(next_sum >> 11) & 3];
+            }
+        }
+    }
+    uint32_t first[rounds];
+    uint32_t second[rounds];
+};
+
+inline uint32_t mix(uint32_t v) { return ((v << 4) ^ (v >> 5)) + v; }
+
+inline uint32_t load(const uint8_t* p) { return p[0] | p[1] << 8u | p[2] << 16u | p[3] << 24u; }
 
-template<typename Round>
-void apply_rounds(uint8_t* data, size_t length, Round round)
+inline void store(uint8_t* p, uint32_t v)
 {
-    for (auto j = 0u; j < length; j += 8) {
-        uint32_t left = data[j+0] | data[j+1] << 8u | data[j+2] << 16u | data[j+3] << 24u,
-                right = data[j+4] | data[j+5] << 8u | data[j+6] << 16u | data[j+7] << 24u;
+    p[0] = static_cast<uint8_t>(v);
+    p[1] = static_cast<uint8_t>(v >> 8u);
+    p[2] = static_cast<uint8_t>(v >> 16u);
+    p[3] = static_cast<uint8_t>(v >> 24u);
+}
+
+// runs all rounds over Lanes blocks at once, independent lanes let the compiler vectorize
+template<int Lanes, bool Decrypt>
+void process_blocks(uint8_t* data, const RoundKeys& keys)
+{
+    uint32_t left[Lanes], right[Lanes];
+    for(int l = 0; l < Lanes; ++l) {
+        left[l] = load(data + l*8);
+        right[l] = load(data + l*8 + 4);
+    }
+
+    for(int i = 0; i < rounds; ++i) {
+        if(Decrypt) {
+            for(int l = 0; l < Lanes; ++l)
+                right[l] -= mix(left[l]) ^ keys.first[i];
+            for(int l = 0; l < Lanes; ++l)
+                left[l] -= mix(right[l]) ^ keys.second[i];
+        } else {
+            for(int l = 0; l < Lanes; ++l)
+                left[l] += mix(right[l]) ^ keys.first[i];
+            for(int l = 0; l < Lanes; ++l)
+                right[l] += mix(left[l]) ^ keys.second[i];
+        }
+    }
+
+    for(int l = 0; l < Lanes; ++l) {
+        store(data + l*8, left[l]);
+        store(data + l*8 + 4, right[l]);
+    }
+}
 
-        round(left, right);
+#ifdef XTEA_SSE2
+inline __m128i mix(__m128i v) { return _mm_add_epi32(_mm_xor_si128(_mm_slli_epi32(v, 4), _mm_srli_epi32(v, 5)), v); }
 
-        data[j] = static_cast<uint8_t>(left);
-        data[j+1] = static_cast<uint8_t>(left >> 8u);
-        data[j+2] = static_cast<uint8_t>(left >> 16u);
-        data[j+3] = static_cast<uint8_t>(left >> 24u);
-        data[j+4] = static_cast<uint8_t>(right);
-        data[j+5] = static_cast<uint8_t>(right >> 8u);
-        data[j+6] = static_cast<uint8_t>(right >> 16u);
-        data[j+7] = static_cast<uint8_t>(right >> 24u);
+// 4 blocks per iteration, the halves of each block are split into a left and a right vector
+template<bool Decrypt>
+void process_blocks_sse2(uint8_t* data, const RoundKeys& keys)
+{
+    // [l0 r0 l1 r1] [l2 r2 l3 r3] => [l0 l1 r0 r1] [l2 l3 r2 r3]
+    __m128i a = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)data), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i b = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)(data + 16)), _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i left = _mm_unpacklo_epi64(a, b);
+    __m128i right = _mm_unpackhi_epi64(a, b);
+
+    for(int i = 0; i < rounds; ++i) {
+        __m128i first = _mm_set1_epi32(keys.first[i]);
+        __m128i second = _mm_set1_epi32(keys.second[i]);
+        if(Decrypt) {
+            right = _mm_sub_epi32(right, _mm_xor_si128(mix(left), first));
+            left = _mm_sub_epi32(left, _mm_xor_si128(mix(right), second));
+        } else {
+            left = _mm_add_epi32(left, _mm_xor_si128(mix(right), first));
+            right = _mm_add_epi32(right, _mm_xor_si128(mix(left), second));
+        }
     }
+
+    a = _mm_shuffle_epi32(_mm_unpacklo_epi64(left, right), _MM_SHUFFLE(3, 1, 2, 0));
+    b = _mm_shuffle_epi32(_mm_unpackhi_epi64(left, right), _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i*)data, a);
+    _mm_storeu_si128((__m128i*)(data + 16), b);
+}
+#endif
+
+template<bool Decrypt>
+void xtea_process(uint8_t* data, size_t length, const std::array<uint32, 4>& key)
+{
+    RoundKeys keys(key, Decrypt);
+    size_t j = 0;
+#ifdef XTEA_SSE2
+    for(; j + 32 <= length; j += 32)
+        process_blocks_sse2<Decrypt>(data + j, keys);
+#else
+    for(; j + 32 <= length; j += 32)
+        process_blocks<4, Decrypt>(data + j, keys);
+#endif
+    for(; j + 8 <= length; j += 8)
+        process_blocks<1, Decrypt>(data + j, keys);
 }
 
 }
 
 bool Protocol::xteaDecrypt(const InputMessagePtr& inputMessage)
 {
-    uint16 encryptedSize = inputMessage->getUnreadSize();
+    int encryptedSize = inputMessage->getUnreadSize();
     if(encryptedSize % 8 != 0) {
         g_logger.traceError("invalid encrypted network message");
         return false;
     }
 
-    for (uint32_t i = 0, sum = delta << 5, next_sum = sum - delta; i < 32; ++i, sum = next_sum, next_sum -= delta) {
-        apply_rounds(inputMessage->getReadBuffer(), encryptedSize, [&](uint32_t& left, uint32_t& right) {
-            right -= ((left << 4 ^ left >> 5) + left) ^ (sum + m_xteaKey[(sum >> 11) & 3]);
-            left -= ((right << 4 ^ right >> 5) + right) ^ (next_sum + m_xteaKey[next_sum & 3]);
-        });
-    };
+    xtea_process<true>(inputMessage->getReadBuffer(), encryptedSize, m_xteaKey);
 
     uint16 decryptedSize = inputMessage->getU16() + 2;
     int sizeDelta = decryptedSize - encryptedSize;
@@ -221,12 +339,7 @@ void Protocol::xteaEncrypt(const OutputMessagePtr& outputMessage)
         encryptedSize += n;
     }
 
-    for (uint32_t i = 0, sum = 0, next_sum = sum + delta; i < 32; ++i, sum = next_sum, next_sum += delta) {
-        apply_rounds(outputMessage->getDataBuffer() - 2, encryptedSize, [&](uint32_t& left, uint32_t& right) {
-            left += ((right << 4 ^ right >> 5) + right) ^ (sum + m_xteaKey[sum & 3]);
-            right += ((left << 4 ^ left >> 5) + left) ^ (next_sum + m_xteaKey[(next_sum >> 11) & 3]);
-        });
-    };
+    xtea_process<false>(outputMessage->getDataBuffer() - 2, encryptedSize, m_xteaKey);
 }
 
 void Protocol::onConnect()
@@ -55,6 +55,7 @@ public:
     void enableChecksum() { m_checksumEnabled = true; }
 
     virtual void send(const OutputMessagePtr& outputMessage);
+    void flush();
     virtual void recv();
 
     ProtocolPtr asProtocol() { return static_self_cast<Protocol>(); }
@@ -67,14 +68,18 @@ protected:
     std::array<uint32, 4> m_xteaKey;
 
 private:
-    void internalRecvHeader(uint8* buffer, uint16 size);
     void internalRecvData(uint8* buffer, uint16 size);
+    void internalDispatchPackets();
+    void internalRecvPacket();
 
     bool xteaDecrypt(const InputMessagePtr& inputMessage);
     void xteaEncrypt(const OutputMessagePtr& outputMessage);
 
     bool m_checksumEnabled;
     bool m_xteaEncryptionEnabled;
+    bool m_recvRequested;
+    bool m_reading;
+    bool m_dispatching;
     ConnectionPtr m_connection;
     InputMessagePtr m_inputMessage;
 };
@@ -23,24 +23,89 @@
 #include "math.h"
 #include <random>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define ADLER32_SSE2
+#endif
+
 #ifdef _MSC_VER
     #pragma warning(disable:4267) // '?' : conversion from 'A' to 'B', possible loss of data
 #endif
 
 namespace stdext {
 
+namespace {
+
+const uint32_t ADLER_BASE = 65521;
+// largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits, it is also a multiple of 16
+const size_t ADLER_NMAX = 5552;
+
+#ifdef ADLER32_SSE2
+uint32_t hsum(__m128i v)
+{
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+    v = _mm_add_epi32(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(v);
+}
+
+// sums 16 bytes per iteration, the byte sums and their position weighted sums are kept in separated lanes
+void adler32_sse2(const uint8_t *buffer, size_t size, size_t& a, size_t& b)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lowWeights = _mm_setr_epi16(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m128i highWeights = _mm_setr_epi16(8, 7, 6, 5, 4, 3, 2, 1);
+    __m128i sums = zero, weightedSums = zero, previousSums = zero;
+
+    b += a * size;
+    for(size_t i = 0; i < size; i += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(buffer + i));
+        previousSums = _mm_add_epi32(previousSums, sums);
+        sums = _mm_add_epi32(sums, _mm_sad_epu8(bytes, zero));
+        weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpacklo_epi8(bytes, zero), lowWeights));
+        weightedSums = _mm_add_epi32(weightedSums, _mm_madd_epi16(_mm_unpackhi_epi8(bytes, zero), highWeights));
+    }
+    // each 16 bytes block adds the sum of all previous blocks 16 times to b
+    weightedSums = _mm_add_epi32(weightedSums, _mm_slli_epi32(previousSums, 4));
+
+    a += hsum(sums);
+    b += hsum(weightedSums);
+}
+#endif
+
+}
+
 uint32_t adler32(const uint8_t *buffer, size_t size) {
     size_t a = 1, b = 0, tlen;
     while(size > 0) {
-        tlen = size > 5552 ? 5552 : size;
+        tlen = size > ADLER_NMAX ? ADLER_NMAX : size;
         size -= tlen;
-        do {
+
+#ifdef ADLER32_SSE2
+        size_t vlen = tlen & ~(size_t)15;
+        if(vlen > 0) {
+            adler32_sse2(buffer, vlen, a, b);
+            buffer += vlen;
+            tlen -= vlen;
+        }
+#else
+        for(; tlen >= 8; tlen -= 8, buffer += 8) {
+            a += buffer[0]; b += a;
+            a += buffer[1]; b += a;
+            a += buffer[2]; b += a;
+            a += buffer[3]; b += a;
+            a += buffer[4]; b += a;
+            a += buffer[5]; b += a;
+            a += buffer[6]; b += a;
+            a += buffer[7]; b += a;
+        }
+#endif
+        for(; tlen > 0; --tlen) {
             a += *buffer++;
             b += a;
-        } while (--tlen);
+        }
 
-        a %= 65521;
-        b %= 65521;
+        a %= ADLER_BASE;
+        b %= ADLER_BASE;
     }
     return (b << 16) | a;
 }
@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2010-2020 OTClient <https://github.com/edubart/otclient>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef STDEXT_OBJECTPOOL_H
+#define STDEXT_OBJECTPOOL_H
+
+#include "types.h"
+#include <new>
+#include <vector>
+#include <type_traits>
+
+namespace stdext {
+
+// fixed size slots carved from slabs of SlabSlots objects, freed slots are reused before a new slab is allocated
+// and slabs are kept until exit, it's not thread safe and is meant to back a class operator new/delete for
+// objects created and destroyed in large numbers. Such a pool should be allocated once and never destroyed,
+// so objects still referenced during static destruction can be released into it.
+template<typename T, std::size_t SlabSlots = 256>
+class object_pool {
+    union slot {
+        slot *next;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+public:
+    object_pool() : m_free(nullptr), m_used(0), m_peak(0), m_allocations(0), m_fallbacks(0) { }
+
+    void *allocate(std::size_t size) {
+        // derived classes have a different size, they use the global allocator
+        if(size != sizeof(T)) {
+            m_fallbacks++;
+            return ::operator new(size);
+        }
+
+        if(!m_free)
+            grow();
+
+        slot *s = m_free;
+        m_free = s->next;
+        m_allocations++;
+        if(++m_used > m_peak)
+            m_peak = m_used;
+        return s;
+    }
+
+    void deallocate(void *p, std::size_t size) {
+        if(!p)
+            return;
+
+        if(size != sizeof(T)) {
+            ::operator delete(p);
+            return;
+        }
+
+        // the last freed slot is the first reused, its memory is likely still cached
+        slot *s = static_cast<slot*>(p);
+        s->next = m_free;
+        m_free = s;
+        m_used--;
+    }
+
+    std::size_t used() const { return m_used; }
+    std::size_t capacity() const { return m_slabs.size() * SlabSlots; }
+    std::size_t slabs() const { return m_slabs.size(); }
+    std::size_t peak() const { return m_peak; }
+    std::size_t allocations() const { return m_allocations; }
+    std::size_t fallbacks() const { return m_fallbacks; }
+
+private:
+    void grow() {
+        slot *slab = static_cast<slot*>(::operator new(sizeof(slot) * SlabSlots));
+        m_slabs.push_back(slab);
+
+        // chained backwards so the slab is handed out in address order
+        for(std::size_t i = SlabSlots; i-- > 0;) {
+            slab[i].next = m_free;
+            m_free = &slab[i];
+        }
+    }
+
+    std::vector<slot*> m_slabs;
+    slot *m_free;
+    std::size_t m_used;
+    std::size_t m_peak;
+    std::size_t m_allocations;
+    std::size_t m_fallbacks;
+};
+
+}
+
+#endif
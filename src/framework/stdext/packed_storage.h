@@ -41,8 +41,18 @@ class packed_storage {
 
 public:
     packed_storage() : m_values(nullptr), m_size(0) { }
+    packed_storage(const packed_storage& other) : m_values(other.m_size > 0 ? new value_pair[other.m_size] : nullptr), m_size(other.m_size) {
+        std::copy(other.m_values, other.m_values + m_size, m_values);
+    }
     ~packed_storage() { delete[] m_values; }
 
+    packed_storage& operator=(const packed_storage& other) {
+        packed_storage tmp(other);
+        std::swap(m_values, tmp.m_values);
+        std::swap(m_size, tmp.m_size);
+        return *this;
+    }
+
     template<typename T>
     void set(Key id, const T& value) {
         for(SizeType i=0;i<m_size;++i) {
@@ -33,6 +33,7 @@
 #include "exception.h"
 #include "format.h"
 #include "math.h"
+#include "object_pool.h"
 #include "packed_any.h"
 #include "packed_storage.h"
 #include "shared_object.h"
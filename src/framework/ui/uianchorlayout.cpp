@@ -159,47 +159,26 @@ void UIAnchorLayout::removeWidget(const UIWidgetPtr& widget)
     removeAnchors(widget);
 }
 
-bool UIAnchorLayout::updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, UIWidgetPtr first)
+bool UIAnchorLayout::updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, const std::vector<UIWidgetPtr>& hookedWidgets)
 {
     UIWidgetPtr parentWidget = getParentWidget();
     if(!parentWidget)
         return false;
 
-    if(first == widget) {
-        g_logger.error(stdext::format("child '%s' of parent widget '%s' is recursively anchored to itself, please fix this", widget->getId(), parentWidget->getId()));
-        return false;
-    }
-
-    if(!first)
-        first = widget;
-
     Rect newRect = widget->getRect();
     bool verticalMoved = false;
     bool horizontalMoved = false;
 
     // calculates new rect based on anchors
-    for(const UIAnchorPtr& anchor : anchorGroup->getAnchors()) {
-        // skip invalid anchors
-        if(anchor->getHookedEdge() == Fw::AnchorNone)
-            continue;
-
-        // determine hooked widget
-        UIWidgetPtr hookedWidget = anchor->getHookedWidget(widget, parentWidget);
+    const UIAnchorList& anchors = anchorGroup->getAnchors();
+    for(uint i = 0; i < anchors.size(); ++i) {
+        const UIAnchorPtr& anchor = anchors[i];
+        const UIWidgetPtr& hookedWidget = hookedWidgets[i];
 
         // skip invalid anchors
         if(!hookedWidget)
             continue;
 
-        if(hookedWidget != getParentWidget()) {
-            // update this hooked widget anchors
-            auto it = m_anchorsGroups.find(hookedWidget);
-            if(it != m_anchorsGroups.end()) {
-                const UIAnchorGroupPtr& hookedAnchorGroup = it->second;
-                if(!hookedAnchorGroup->isUpdated())
-                    updateWidget(hookedWidget, hookedAnchorGroup, first);
-            }
-        }
-
         int point = anchor->getHookedPoint(hookedWidget, parentWidget);
 
         switch(anchor->getAnchoredEdge()) {
@@ -244,29 +223,81 @@ bool UIAnchorLayout::updateWidget(const UIWidgetPtr& widget, const UIAnchorGroup
         }
     }
 
-    bool changed = false;
-    if(widget->setRect(newRect))
-        changed = true;
-    anchorGroup->setUpdated(true);
-    return changed;
+    return widget->setRect(newRect);
 }
 
 bool UIAnchorLayout::internalUpdate()
 {
-    bool changed = false;
+    UIWidgetPtr parentWidget = getParentWidget();
+    if(!parentWidget)
+        return false;
 
-    // reset all anchors groups update state
+    // anchored widgets are solved in dependency order, a widget only after the siblings it is hooked to
+    struct AnchorNode {
+        UIWidgetPtr widget;
+        UIAnchorGroupPtr anchorGroup;
+        std::vector<UIWidgetPtr> hookedWidgets;
+        std::vector<int> dependents;
+        int pending;
+    };
+
+    std::vector<AnchorNode> nodes;
+    std::unordered_map<UIWidgetPtr, int> nodeIndexes;
+    nodes.reserve(m_anchorsGroups.size());
     for(auto& it : m_anchorsGroups) {
-        const UIAnchorGroupPtr& anchorGroup = it.second;
-        anchorGroup->setUpdated(false);
+        nodeIndexes[it.first] = nodes.size();
+        nodes.push_back(AnchorNode());
+        AnchorNode& node = nodes.back();
+        node.widget = it.first;
+        node.anchorGroup = it.second;
+        node.pending = 0;
     }
 
-    // update all anchors
-    for(auto& it : m_anchorsGroups) {
-        const UIWidgetPtr& widget = it.first;
-        const UIAnchorGroupPtr& anchorGroup = it.second;
-        if(!anchorGroup->isUpdated()) {
-            if(updateWidget(widget, anchorGroup))
+    // resolve hooked widgets once and link each widget to the anchored siblings it depends on
+    for(int i = 0; i < (int)nodes.size(); ++i) {
+        AnchorNode& node = nodes[i];
+        for(const UIAnchorPtr& anchor : node.anchorGroup->getAnchors()) {
+            UIWidgetPtr hookedWidget;
+            if(anchor->getHookedEdge() != Fw::AnchorNone)
+                hookedWidget = anchor->getHookedWidget(node.widget, parentWidget);
+            node.hookedWidgets.push_back(hookedWidget);
+
+            if(!hookedWidget || hookedWidget == parentWidget)
+                continue;
+
+            auto it = nodeIndexes.find(hookedWidget);
+            if(it != nodeIndexes.end()) {
+                nodes[it->second].dependents.push_back(i);
+                node.pending++;
+            }
+        }
+    }
+
+    std::vector<int> ready;
+    ready.reserve(nodes.size());
+    for(int i = 0; i < (int)nodes.size(); ++i) {
+        if(nodes[i].pending == 0)
+            ready.push_back(i);
+    }
+
+    bool changed = false;
+    for(uint i = 0; i < ready.size(); ++i) {
+        AnchorNode& node = nodes[ready[i]];
+        if(updateWidget(node.widget, node.anchorGroup, node.hookedWidgets))
+            changed = true;
+        for(int dependent : node.dependents) {
+            if(--nodes[dependent].pending == 0)
+                ready.push_back(dependent);
+        }
+    }
+
+    // widgets left are in anchor cycles or hooked to one, they are still placed from the current rects
+    if(ready.size() != nodes.size()) {
+        for(AnchorNode& node : nodes) {
+            if(node.pending == 0)
+                continue;
+            g_logger.error(stdext::format("child '%s' of parent widget '%s' is recursively anchored to itself, please fix this", node.widget->getId(), parentWidget->getId()));
+            if(updateWidget(node.widget, node.anchorGroup, node.hookedWidgets))
                 changed = true;
         }
     }
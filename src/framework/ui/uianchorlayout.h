@@ -46,16 +46,11 @@ protected:
 class UIAnchorGroup : public stdext::shared_object
 {
 public:
-    UIAnchorGroup() : m_updated(true) { }
-
     void addAnchor(const UIAnchorPtr& anchor);
     const UIAnchorList& getAnchors() { return m_anchors; }
-    bool isUpdated() { return m_updated; }
-    void setUpdated(bool updated) { m_updated = updated; }
 
 private:
     UIAnchorList m_anchors;
-    bool m_updated;
 };
 
 // @bindclass
@@ -78,7 +73,7 @@ public:
 
 protected:
     virtual bool internalUpdate();
-    virtual bool updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, UIWidgetPtr first = nullptr);
+    virtual bool updateWidget(const UIWidgetPtr& widget, const UIAnchorGroupPtr& anchorGroup, const std::vector<UIWidgetPtr>& hookedWidgets);
     std::unordered_map<UIWidgetPtr, UIAnchorGroupPtr> m_anchorsGroups;
 };
 
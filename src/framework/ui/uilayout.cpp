@@ -22,8 +22,9 @@
 
 #include "uilayout.h"
 #include "uiwidget.h"
+#include "uimanager.h"
 
-#include <framework/core/eventdispatcher.h>
+#include <framework/core/profiler.h>
 
 void UILayout::update()
 {
@@ -49,8 +50,10 @@ void UILayout::update()
         return;
     }
 
+    ProfilerZone zone("layout");
     m_updating = true;
     internalUpdate();
+    g_ui.onLayoutUpdate(m_parentWidget->getChildCount());
     m_parentWidget->onLayoutUpdate();
     m_updating = false;
 }
@@ -63,10 +66,6 @@ void UILayout::updateLater()
     if(!getParentWidget())
         return;
 
-    auto self = static_self_cast<UILayout>();
-    g_dispatcher.addEvent([self] {
-        self->m_updateScheduled = false;
-        self->update();
-    });
+    g_ui.scheduleLayoutUpdate(static_self_cast<UILayout>());
     m_updateScheduled = true;
 }
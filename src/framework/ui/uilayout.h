@@ -56,6 +56,9 @@ public:
 
 protected:
     virtual bool internalUpdate() { return false; }
+    void runScheduledUpdate() { m_updateScheduled = false; update(); }
+
+    friend class UIManager;
 
     int m_updateDisabled;
     stdext::boolean<false> m_updating;
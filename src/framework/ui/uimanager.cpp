@@ -39,6 +39,8 @@ void UIManager::init()
     m_rootWidget->setId("root");
     m_mouseReceiver = m_rootWidget;
     m_keyboardReceiver = m_rootWidget;
+    m_layoutUpdates = m_layoutWidgets = 0;
+    m_lastLayoutUpdates = m_lastLayoutWidgets = 0;
 }
 
 void UIManager::terminate()
@@ -54,10 +56,20 @@ void UIManager::terminate()
     m_styles.clear();
     m_destroyedWidgets.clear();
     m_checkEvent = nullptr;
+    m_widgetsById.clear();
+    m_pendingLayouts.clear();
 }
 
 void UIManager::render(Fw::DrawPane drawPane)
 {
+    // the background pane is drawn once per frame
+    if(drawPane & Fw::BackgroundPane) {
+        m_lastLayoutUpdates = m_layoutUpdates;
+        m_lastLayoutWidgets = m_layoutWidgets;
+        m_layoutUpdates = 0;
+        m_layoutWidgets = 0;
+    }
+
     m_rootWidget->draw(m_rootWidget->getRect(), drawPane);
 }
 
@@ -259,12 +271,82 @@ void UIManager::onWidgetAppear(const UIWidgetPtr& widget)
 {
     if(widget->containsPoint(g_window.getMousePosition()))
         updateHoveredWidget();
+    g_app.repaint();
 }
 
 void UIManager::onWidgetDisappear(const UIWidgetPtr& widget)
 {
     if(widget->containsPoint(g_window.getMousePosition()))
         updateHoveredWidget();
+    g_app.repaint();
+}
+
+void UIManager::onWidgetIdChange(UIWidget *widget, const std::string& oldId, const std::string& newId)
+{
+    if(!oldId.empty()) {
+        auto it = m_widgetsById.find(oldId);
+        if(it != m_widgetsById.end()) {
+            std::vector<UIWidget*>& widgets = it->second;
+            auto wit = std::find(widgets.begin(), widgets.end(), widget);
+            if(wit != widgets.end()) {
+                *wit = widgets.back();
+                widgets.pop_back();
+            }
+            if(widgets.empty())
+                m_widgetsById.erase(it);
+        }
+    }
+
+    if(!newId.empty())
+        m_widgetsById[newId].push_back(widget);
+}
+
+void UIManager::scheduleLayoutUpdate(const UILayoutPtr& layout)
+{
+    m_pendingLayouts.push_back(layout);
+    if(m_layoutUpdateScheduled)
+        return;
+
+    g_dispatcher.addEvent([this] { updateLayouts(); });
+    m_layoutUpdateScheduled = true;
+}
+
+void UIManager::onLayoutUpdate(int widgets)
+{
+    m_layoutUpdates++;
+    m_layoutWidgets += widgets;
+}
+
+void UIManager::updateLayouts()
+{
+    m_layoutUpdateScheduled = false;
+
+    // layouts scheduled while updating go to the next batch
+    std::vector<UILayoutPtr> layouts;
+    layouts.swap(m_pendingLayouts);
+
+    // outer layouts first, they resize the widgets the inner layouts are hooked to
+    std::vector<std::pair<int, int>> order;
+    order.reserve(layouts.size());
+    for(int i = 0; i < (int)layouts.size(); ++i) {
+        int depth = 0;
+        for(UIWidgetPtr widget = layouts[i]->getParentWidget(); widget; widget = widget->getParent())
+            depth++;
+        order.push_back(std::make_pair(depth, i));
+    }
+    std::sort(order.begin(), order.end());
+
+    for(const auto& it : order)
+        layouts[it.second]->runScheduledUpdate();
+}
+
+const std::vector<UIWidget*>& UIManager::getWidgetsById(const std::string& id)
+{
+    static const std::vector<UIWidget*> emptyList;
+    auto it = m_widgetsById.find(id);
+    if(it == m_widgetsById.end())
+        return emptyList;
+    return it->second;
 }
 
 void UIManager::onWidgetDestroy(const UIWidgetPtr& widget)
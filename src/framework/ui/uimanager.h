@@ -70,12 +70,22 @@ public:
 
     bool isDrawingDebugBoxes() { return m_drawDebugBoxes; }
 
+    // layout updates and widgets laid out by them during the last frame
+    int getLayoutUpdates() { return m_lastLayoutUpdates; }
+    int getLayoutWidgets() { return m_lastLayoutWidgets; }
+
 protected:
     void onWidgetAppear(const UIWidgetPtr& widget);
     void onWidgetDisappear(const UIWidgetPtr& widget);
     void onWidgetDestroy(const UIWidgetPtr& widget);
+    void onWidgetIdChange(UIWidget *widget, const std::string& oldId, const std::string& newId);
+    const std::vector<UIWidget*>& getWidgetsById(const std::string& id);
+    void scheduleLayoutUpdate(const UILayoutPtr& layout);
+    void onLayoutUpdate(int widgets);
+    void updateLayouts();
 
     friend class UIWidget;
+    friend class UILayout;
 
 private:
     UIWidgetPtr m_rootWidget;
@@ -89,6 +99,14 @@ private:
     std::unordered_map<std::string, OTMLNodePtr> m_styles;
     UIWidgetList m_destroyedWidgets;
     ScheduledEventPtr m_checkEvent;
+    // raw pointers because widgets leave the registry from their destructor
+    std::unordered_map<std::string, std::vector<UIWidget*>> m_widgetsById;
+    std::vector<UILayoutPtr> m_pendingLayouts;
+    stdext::boolean<false> m_layoutUpdateScheduled;
+    int m_layoutUpdates;
+    int m_layoutWidgets;
+    int m_lastLayoutUpdates;
+    int m_lastLayoutWidgets;
 
 };
 
@@ -116,9 +116,12 @@ void UITextEdit::drawSelf(Fw::DrawPane drawPane)
                 g_painter->setColor(m_color);
 
             g_painter->drawFilledRect(cursorRect);
+            g_app.scheduleRepaint(delay - elapsed + 1);
         } else if(elapsed >= 2*delay) {
             m_cursorTicks = g_clock.millis();
-        }
+            g_app.scheduleRepaint(0);
+        } else
+            g_app.scheduleRepaint(2*delay - elapsed);
     }
 
     g_painter->resetColor();
@@ -48,6 +48,8 @@ UIWidget::UIWidget()
 
 UIWidget::~UIWidget()
 {
+    if(!m_destroyed)
+        g_ui.onWidgetIdChange(this, m_id, std::string());
 #ifndef NDEBUG
     assert(!g_app.isTerminated());
     if(!m_destroyed)
@@ -155,6 +157,8 @@ void UIWidget::addChild(const UIWidgetPtr& child)
     UIWidgetPtr oldLastChild = getLastChild();
 
     m_children.push_back(child);
+    m_childrenGridDirty = true;
+    indexChildId(child, child->getId());
     child->setParent(static_self_cast<UIWidget>());
 
     // create default layout
@@ -198,6 +202,8 @@ void UIWidget::insertChild(int index, const UIWidgetPtr& child)
     // retrieve child by index
     auto it = m_children.begin() + index;
     m_children.insert(it, child);
+    m_childrenGridDirty = true;
+    indexChildId(child, child->getId());
     child->setParent(static_self_cast<UIWidget>());
 
     // create default layout if needed
@@ -230,6 +236,8 @@ void UIWidget::removeChild(UIWidgetPtr child)
 
         auto it = std::find(m_children.begin(), m_children.end(), child);
         m_children.erase(it);
+        m_childrenGridDirty = true;
+        unindexChildId(child, child->getId());
 
         // reset child parent
         assert(child->getParent() == static_self_cast<UIWidget>());
@@ -388,7 +396,10 @@ void UIWidget::lowerChild(UIWidgetPtr child)
 
     m_children.erase(it);
     m_children.push_front(child);
+    m_childrenGridDirty = true;
+    reindexChildId(child->getId());
     updateChildrenIndexStates();
+    repaint();
 }
 
 void UIWidget::raiseChild(UIWidgetPtr child)
@@ -407,7 +418,10 @@ void UIWidget::raiseChild(UIWidgetPtr child)
     }
     m_children.erase(it);
     m_children.push_back(child);
+    m_childrenGridDirty = true;
+    reindexChildId(child->getId());
     updateChildrenIndexStates();
+    repaint();
 }
 
 void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
@@ -431,8 +445,11 @@ void UIWidget::moveChildToIndex(const UIWidgetPtr& child, int index)
     }
     m_children.erase(it);
     m_children.insert(m_children.begin() + index - 1, child);
+    m_childrenGridDirty = true;
+    reindexChildId(child->getId());
     updateChildrenIndexStates();
     updateLayout();
+    repaint();
 }
 
 void UIWidget::lockChild(const UIWidgetPtr& child)
@@ -520,6 +537,7 @@ void UIWidget::mergeStyle(const OTMLNodePtr& styleNode)
     m_style->merge(styleNode);
     m_style->setTag(name);
     m_style->setSource(source);
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -642,6 +660,12 @@ void UIWidget::updateLayout()
             parentLayout->updateLater();
 }
 
+void UIWidget::repaint()
+{
+    // widgets are drawn in the foreground pane, changing one damages the next frame
+    g_app.repaint();
+}
+
 void UIWidget::lock()
 {
     if(m_destroyed)
@@ -763,6 +787,10 @@ void UIWidget::internalDestroy()
     for(const UIWidgetPtr& child : m_children)
         child->internalDestroy();
     m_children.clear();
+    m_childrenById.clear();
+    m_childrenGrid = nullptr;
+    m_childrenGridDirty = true;
+    g_ui.onWidgetIdChange(this, m_id, std::string());
 
     callLuaField("onDestroy");
 
@@ -797,6 +825,8 @@ void UIWidget::destroyChildren()
     while(!m_children.empty()) {
         UIWidgetPtr child = m_children.front();
         m_children.pop_front();
+        m_childrenGridDirty = true;
+        unindexChildId(child, child->getId());
         child->setParent(nullptr);
         m_layout->removeWidget(child);
         child->destroy();
@@ -809,7 +839,15 @@ void UIWidget::destroyChildren()
 void UIWidget::setId(const std::string& id)
 {
     if(id != m_id) {
+        std::string oldId = m_id;
         m_id = id;
+        if(!m_destroyed)
+            g_ui.onWidgetIdChange(this, oldId, id);
+        if(UIWidgetPtr parent = getParent()) {
+            UIWidgetPtr self = static_self_cast<UIWidget>();
+            parent->unindexChildId(self, oldId);
+            parent->indexChildId(self, id);
+        }
         callLuaField("onIdChange", id);
     }
 }
@@ -882,6 +920,10 @@ bool UIWidget::setRect(const Rect& rect)
 
     m_rect = rect;
 
+    // the parent picks children by their rects
+    if(m_parent)
+        m_parent->m_childrenGridDirty = true;
+
     // updates own layout
     updateLayout();
 
@@ -913,6 +955,7 @@ void UIWidget::setStyle(const std::string& styleName)
     styleNode = styleNode->clone();
     applyStyle(styleNode);
     m_style = styleNode;
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -920,6 +963,7 @@ void UIWidget::setStyleFromNode(const OTMLNodePtr& styleNode)
 {
     applyStyle(styleNode);
     m_style = styleNode;
+    m_compiledStyle = nullptr;
     updateStyle();
 }
 
@@ -1016,6 +1060,7 @@ void UIWidget::setVirtualOffset(const Point& offset)
     m_virtualOffset = offset;
     if(m_layout)
         m_layout->update();
+    repaint();
 }
 
 bool UIWidget::isAnchored()
@@ -1128,11 +1173,118 @@ UIWidgetPtr UIWidget::getChildBefore(const UIWidgetPtr& relativeChild)
 
 UIWidgetPtr UIWidget::getChildById(const std::string& childId)
 {
+    auto it = m_childrenById.find(childId);
+    if(it == m_childrenById.end())
+        return nullptr;
+    return it->second.first;
+}
+
+// children are picked from a grid only when there are enough of them to pay for building it
+static const uint CHILDREN_GRID_MIN_CHILDREN = 32;
+
+template<typename F>
+void UIWidget::forEachChildAt(const Point& pos, bool topFirst, F f)
+{
+    if(m_childrenGridDirty)
+        updateChildrenGrid();
+
+    if(!m_childrenGrid) {
+        if(topFirst) {
+            for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
+                if(f(*it))
+                    return;
+            }
+        } else {
+            for(auto it = m_children.begin(); it != m_children.end(); ++it) {
+                if(f(*it))
+                    return;
+            }
+        }
+        return;
+    }
+
+    const ChildrenGrid& grid = *m_childrenGrid;
+    if(!grid.bounds.contains(pos))
+        return;
+
+    int column = std::min<int>((pos.x - grid.bounds.left()) / grid.cellWidth, grid.columns - 1);
+    int row = std::min<int>((pos.y - grid.bounds.top()) / grid.cellHeight, grid.rows - 1);
+    const std::vector<int>& cell = grid.cells[row * grid.columns + column];
+    const std::vector<int>& large = grid.large;
+
+    // both lists are sorted by child index, merge them in the requested order
+    if(topFirst) {
+        int i = (int)cell.size() - 1, j = (int)large.size() - 1;
+        while(i >= 0 || j >= 0) {
+            int index = (j < 0 || (i >= 0 && cell[i] > large[j])) ? cell[i--] : large[j--];
+            if(f(m_children[index]))
+                return;
+        }
+    } else {
+        uint i = 0, j = 0;
+        while(i < cell.size() || j < large.size()) {
+            int index = (j >= large.size() || (i < cell.size() && cell[i] < large[j])) ? cell[i++] : large[j++];
+            if(f(m_children[index]))
+                return;
+        }
+    }
+}
+
+void UIWidget::updateChildrenGrid()
+{
+    m_childrenGridDirty = false;
+
+    if(m_children.size() < CHILDREN_GRID_MIN_CHILDREN) {
+        m_childrenGrid = nullptr;
+        return;
+    }
+
+    Rect bounds;
     for(const UIWidgetPtr& child : m_children) {
-        if(child->getId() == childId)
-            return child;
+        const Rect& rect = child->getRect();
+        if(rect.isValid())
+            bounds = bounds.isValid() ? bounds.united(rect) : rect;
+    }
+
+    if(!m_childrenGrid)
+        m_childrenGrid.reset(new ChildrenGrid);
+    ChildrenGrid& grid = *m_childrenGrid;
+    grid.bounds = bounds;
+    grid.large.clear();
+    grid.cells.clear();
+    if(!bounds.isValid()) {
+        grid.columns = grid.rows = 0;
+        return;
+    }
+
+    // about one child per cell
+    int side = std::max<int>(1, std::ceil(std::sqrt((float)m_children.size())));
+    grid.columns = std::min<int>(side, bounds.width());
+    grid.rows = std::min<int>(side, bounds.height());
+    grid.cellWidth = (bounds.width() + grid.columns - 1) / grid.columns;
+    grid.cellHeight = (bounds.height() + grid.rows - 1) / grid.rows;
+    grid.cells.resize(grid.columns * grid.rows);
+
+    int maxCells = std::max<int>(1, grid.cells.size() / 4);
+    for(int index = 0; index < (int)m_children.size(); ++index) {
+        const Rect& rect = m_children[index]->getRect();
+        if(!rect.isValid())
+            continue;
+
+        int left = (rect.left() - bounds.left()) / grid.cellWidth;
+        int right = std::min<int>((rect.right() - bounds.left()) / grid.cellWidth, grid.columns - 1);
+        int top = (rect.top() - bounds.top()) / grid.cellHeight;
+        int bottom = std::min<int>((rect.bottom() - bounds.top()) / grid.cellHeight, grid.rows - 1);
+        if((right - left + 1) * (bottom - top + 1) > maxCells) {
+            grid.large.push_back(index);
+            continue;
+        }
+
+        for(int row = top; row <= bottom; ++row) {
+            for(int column = left; column <= right; ++column)
+                grid.cells[row * grid.columns + column].push_back(index);
+        }
     }
-    return nullptr;
 }
 
 UIWidgetPtr UIWidget::getChildByPos(const Point& childPos)
@@ -1140,13 +1292,15 @@ UIWidgetPtr UIWidget::getChildByPos(const Point& childPos)
     if(!containsPaddingPoint(childPos))
         return nullptr;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
-        if(child->isExplicitlyVisible() && child->containsPoint(childPos))
-            return child;
-    }
-
-    return nullptr;
+    UIWidgetPtr found;
+    forEachChildAt(childPos, true, [&](const UIWidgetPtr& child) {
+        if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
+            found = child;
+            return true;
+        }
+        return false;
+    });
+    return found;
 }
 
 UIWidgetPtr UIWidget::getChildByIndex(int index)
@@ -1159,6 +1313,27 @@ UIWidgetPtr UIWidget::getChildByIndex(int index)
 
 UIWidgetPtr UIWidget::recursiveGetChildById(const std::string& id)
 {
+    // an id used by few widgets is resolved from the global registry, the search order
+    // only matters when more than one of them is below this widget
+    const std::vector<UIWidget*>& widgets = g_ui.getWidgetsById(id);
+    if(!id.empty() && widgets.size() <= 16) {
+        UIWidget *found = nullptr;
+        int matches = 0;
+        for(UIWidget *widget : widgets) {
+            for(UIWidget *parent = widget->m_parent.get(); parent; parent = parent->m_parent.get()) {
+                if(parent == this) {
+                    found = widget;
+                    ++matches;
+                    break;
+                }
+            }
+        }
+        if(matches == 0)
+            return nullptr;
+        if(matches == 1)
+            return UIWidgetPtr(found);
+    }
+
     UIWidgetPtr widget = getChildById(id);
     if(!widget) {
         for(const UIWidgetPtr& child : m_children) {
@@ -1170,22 +1345,61 @@ UIWidgetPtr UIWidget::recursiveGetChildById(const std::string& id)
     return widget;
 }
 
+void UIWidget::indexChildId(const UIWidgetPtr& child, const std::string& id)
+{
+    ChildIdEntry& entry = m_childrenById[id];
+    if(++entry.count == 1)
+        entry.first = child;
+    else if(child != m_children.back())
+        entry.first = findFirstChildById(id);
+}
+
+void UIWidget::unindexChildId(const UIWidgetPtr& child, const std::string& id)
+{
+    auto it = m_childrenById.find(id);
+    if(it == m_childrenById.end())
+        return;
+
+    ChildIdEntry& entry = it->second;
+    if(--entry.count == 0)
+        m_childrenById.erase(it);
+    else if(entry.first == child)
+        entry.first = findFirstChildById(id);
+}
+
+void UIWidget::reindexChildId(const std::string& id)
+{
+    auto it = m_childrenById.find(id);
+    if(it != m_childrenById.end() && it->second.count > 1)
+        it->second.first = findFirstChildById(id);
+}
+
+UIWidgetPtr UIWidget::findFirstChildById(const std::string& id)
+{
+    for(const UIWidgetPtr& child : m_children) {
+        if(child->getId() == id)
+            return child;
+    }
+    return nullptr;
+}
+
 UIWidgetPtr UIWidget::recursiveGetChildByPos(const Point& childPos, bool wantsPhantom)
 {
     if(!containsPaddingPoint(childPos))
         return nullptr;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
+    UIWidgetPtr found;
+    forEachChildAt(childPos, true, [&](const UIWidgetPtr& child) {
         if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
             UIWidgetPtr subChild = child->recursiveGetChildByPos(childPos, wantsPhantom);
             if(subChild)
-                return subChild;
+                found = subChild;
             else if(wantsPhantom || !child->isPhantom())
-                return child;
+                found = child;
         }
-    }
-    return nullptr;
+        return !!found;
+    });
+    return found;
 }
 
 UIWidgetList UIWidget::recursiveGetChildren()
@@ -1206,15 +1420,15 @@ UIWidgetList UIWidget::recursiveGetChildrenByPos(const Point& childPos)
     if(!containsPaddingPoint(childPos))
         return children;
 
-    for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-        const UIWidgetPtr& child = (*it);
+    forEachChildAt(childPos, true, [&](const UIWidgetPtr& child) {
         if(child->isExplicitlyVisible() && child->containsPoint(childPos)) {
             UIWidgetList subChildren = child->recursiveGetChildrenByPos(childPos);
             if(!subChildren.empty())
                 children.insert(children.end(), subChildren.begin(), subChildren.end());
             children.push_back(child);
         }
-    }
+        return false;
+    });
     return children;
 }
 
@@ -1415,47 +1629,132 @@ void UIWidget::updateStyle()
     if(!m_style)
         return;
 
-    OTMLNodePtr newStateStyle = OTMLNode::create();
+    if(!m_compiledStyle)
+        compileStyle();
+    CompiledStyle& style = *m_compiledStyle;
 
-    // copy only the changed styles from default style
-    if(m_stateStyle) {
-        for(OTMLNodePtr node : m_stateStyle->children()) {
-            if(OTMLNodePtr otherNode = m_style->get(node->tag()))
-                newStateStyle->addChild(otherNode->clone());
-        }
+    uint64 mask = 0;
+    for(uint i = 0; i < style.selectors.size(); ++i) {
+        const CompiledStyle::Selector& selector = style.selectors[i];
+        if((m_states & selector.onStates) == selector.onStates && (m_states & selector.offStates) == 0)
+            mask |= (uint64)1 << i;
     }
 
-    // checks for states combination
-    for(const OTMLNodePtr& style : m_style->children()) {
-        if(stdext::starts_with(style->tag(), "$")) {
-            std::string statesStr = style->tag().substr(1);
-            std::vector<std::string> statesSplit = stdext::split(statesStr, " ");
+    // the state changed but the same state styles match
+    if(style.applied && mask == style.appliedMask)
+        return;
 
-            bool match = true;
-            for(std::string stateStr : statesSplit) {
-                if(stateStr.length() == 0)
-                    continue;
+    OTMLNodePtr& stateStyle = style.stateStyles[mask];
+    if(!stateStyle) {
+        // properties changed by any state style start from their default value, so leaving a state reverts them
+        stateStyle = OTMLNode::create();
+        for(const OTMLNodePtr& node : style.defaults)
+            stateStyle->addChild(node->clone());
+        for(uint i = 0; i < style.selectors.size(); ++i) {
+            if(mask & ((uint64)1 << i))
+                stateStyle->merge(style.selectors[i].node);
+        }
+    }
 
-                bool notstate = (stateStr[0] == '!');
-                if(notstate)
-                    stateStr = stateStr.substr(1);
+    if(style.hasExpressions) {
+        // '!' properties are lua expressions that applyStyle translates in place, they must be evaluated on every apply
+        applyStyle(stateStyle->clone());
+    } else if(!style.applied) {
+        applyStyle(stateStyle);
+    } else {
+        // only the properties that differ from the applied state style are set
+        OTMLNodePtr& delta = style.deltas[std::make_pair(style.appliedMask, mask)];
+        if(!delta) {
+            const OTMLNodePtr& appliedStyle = style.stateStyles[style.appliedMask];
+            delta = OTMLNode::create(stateStyle->tag());
+            delta->setSource(stateStyle->source());
+
+            OTMLNodeList nodes = stateStyle->children();
+            for(uint i = 0; i < nodes.size(); ++i) {
+                const OTMLNodePtr& node = nodes[i];
+
+                // repeated properties are applied in order, so only the last one takes effect
+                bool overridden = false;
+                for(uint j = i + 1; j < nodes.size() && !overridden; ++j)
+                    overridden = nodes[j]->tag() == node->tag();
+                if(overridden)
+                    continue;
 
-                bool stateOn = hasState(Fw::translateState(stateStr));
-                if((!notstate && !stateOn) || (notstate && stateOn))
-                    match = false;
+                OTMLNodePtr appliedNode;
+                for(const OTMLNodePtr& other : appliedStyle->children()) {
+                    if(other->tag() == node->tag())
+                        appliedNode = other;
+                }
+                if(!appliedNode || appliedNode->emit() != node->emit())
+                    delta->addChild(node->clone());
             }
+        }
+        applyStyle(delta);
+    }
+
+    style.applied = true;
+    style.appliedMask = mask;
+}
+
+void UIWidget::compileStyle()
+{
+    m_compiledStyle.reset(new CompiledStyle);
+    CompiledStyle& style = *m_compiledStyle;
+    style.hasExpressions = false;
+    style.applied = false;
+    style.appliedMask = 0;
+
+    std::set<std::string> tags;
+    for(const OTMLNodePtr& node : m_style->children()) {
+        if(!stdext::starts_with(node->tag(), "$"))
+            continue;
+
+        if(style.selectors.size() == 64) {
+            g_logger.traceError(stdext::format("style '%s' has more than 64 state styles, the others are ignored", m_style->tag()));
+            break;
+        }
 
-            // merge states styles
-            if(match) {
-                newStateStyle->merge(style);
+        CompiledStyle::Selector selector;
+        selector.onStates = 0;
+        selector.offStates = 0;
+        selector.node = node;
+        for(std::string stateStr : stdext::split(node->tag().substr(1), " ")) {
+            if(stateStr.length() == 0)
+                continue;
+
+            bool notstate = (stateStr[0] == '!');
+            if(notstate)
+                stateStr = stateStr.substr(1);
+
+            // an unknown state is never on
+            Fw::WidgetState state = Fw::translateState(stateStr);
+            if(state == Fw::InvalidState) {
+                if(!notstate)
+                    selector.onStates = Fw::LastWidgetState;
+                continue;
             }
+
+            if(notstate)
+                selector.offStates |= state;
+            else
+                selector.onStates |= state;
         }
-    }
+        style.selectors.push_back(selector);
 
-    //TODO: prevent setting already set proprieties
+        for(const OTMLNodePtr& child : node->children()) {
+            tags.insert(child->tag());
+            if(child->tag()[0] == '!')
+                style.hasExpressions = true;
+        }
+    }
 
-    applyStyle(newStateStyle);
-    m_stateStyle = newStateStyle;
+    for(const OTMLNodePtr& node : m_style->children()) {
+        if(tags.count(node->tag())) {
+            style.defaults.push_back(node);
+            if(node->tag()[0] == '!')
+                style.hasExpressions = true;
+        }
+    }
 }
 
 void UIWidget::onStyleApply(const std::string& styleName, const OTMLNodePtr& styleNode)
@@ -1692,15 +1991,13 @@ bool UIWidget::propagateOnMouseEvent(const Point& mousePos, UIWidgetList& widget
 {
     bool ret = false;
     if(containsPaddingPoint(mousePos)) {
-        for(auto it = m_children.rbegin(); it != m_children.rend(); ++it) {
-            const UIWidgetPtr& child = *it;
+        forEachChildAt(mousePos, true, [&](const UIWidgetPtr& child) {
             if(child->isExplicitlyEnabled() && child->isExplicitlyVisible() && child->containsPoint(mousePos)) {
-                if(child->propagateOnMouseEvent(mousePos, widgetList)) {
+                if(child->propagateOnMouseEvent(mousePos, widgetList))
                     ret = true;
-                    break;
-                }
             }
-        }
+            return ret;
+        });
     }
 
     widgetList.push_back(static_self_cast<UIWidget>());
@@ -1713,11 +2010,11 @@ bool UIWidget::propagateOnMouseEvent(const Point& mousePos, UIWidgetList& widget
 bool UIWidget::propagateOnMouseMove(const Point& mousePos, const Point& mouseMoved, UIWidgetList& widgetList)
 {
     if(containsPaddingPoint(mousePos)) {
-        for(auto &child: m_children) {
+        forEachChildAt(mousePos, false, [&](const UIWidgetPtr& child) {
             if(child->isExplicitlyVisible() && child->isExplicitlyEnabled() && child->containsPoint(mousePos))
                 child->propagateOnMouseMove(mousePos, mouseMoved, widgetList);
-
-        }
+            return false;
+        });
     }
 
     widgetList.push_back(static_self_cast<UIWidget>());
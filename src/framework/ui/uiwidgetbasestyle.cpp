@@ -26,6 +26,7 @@
 #include "uigridlayout.h"
 #include "uianchorlayout.h"
 #include "uitranslator.h"
+#include "uimanager.h"
 
 #include <framework/graphics/painter.h>
 #include <framework/graphics/texture.h>
@@ -44,6 +45,7 @@ void UIWidget::initBaseStyle()
     // generate an unique id, this is need because anchored layouts find widgets by id
     static unsigned long id = 1;
     m_id = stdext::format("widget%d", id++);
+    g_ui.onWidgetIdChange(this, std::string(), m_id);
 }
 
 void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
@@ -106,6 +108,8 @@ void UIWidget::parseBaseStyle(const OTMLNodePtr& styleNode)
             setIcon(stdext::resolve_path(node->value(), node->source()));
         else if(node->tag() == "icon-source")
             setIcon(stdext::resolve_path(node->value(), node->source()));
+        else if(node->tag() == "icon-source-async")
+            setIconAsync(stdext::resolve_path(node->value(), node->source()));
         else if(node->tag() == "icon-color")
             setIconColor(node->value<Color>());
         else if(node->tag() == "icon-offset-x")
@@ -407,4 +411,22 @@ void UIWidget::setIcon(const std::string& iconFile)
         m_icon = g_textures.getTexture(iconFile);
     if(m_icon && !m_iconClipRect.isValid())
         m_iconClipRect = Rect(0, 0, m_icon->getSize());
+    repaint();
+}
+
+void UIWidget::setIconAsync(const std::string& iconFile)
+{
+    repaint();
+    if(iconFile.empty()) {
+        m_icon = nullptr;
+        return;
+    }
+
+    m_icon = g_textures.getTextureAsync(iconFile);
+    UIWidgetPtr self = static_self_cast<UIWidget>();
+    TexturePtr icon = m_icon;
+    g_textures.whenLoaded(icon, [self, icon] {
+        if(self->m_icon == icon && !self->m_iconClipRect.isValid())
+            self->m_iconClipRect = Rect(0, 0, icon->getSize());
+    });
 }
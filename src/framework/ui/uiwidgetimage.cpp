@@ -36,6 +36,8 @@ void UIWidget::parseImageStyle(const OTMLNodePtr& styleNode)
     for(const OTMLNodePtr& node : styleNode->children()) {
         if(node->tag() == "image-source")
             setImageSource(stdext::resolve_path(node->value(), node->source()));
+        else if(node->tag() == "image-source-async")
+            setImageSourceAsync(stdext::resolve_path(node->value(), node->source()));
         else if(node->tag() == "image-offset-x")
             setImageOffsetX(node->value<int>());
         else if(node->tag() == "image-offset-y")
@@ -77,7 +79,7 @@ void UIWidget::parseImageStyle(const OTMLNodePtr& styleNode)
 
 void UIWidget::drawImage(const Rect& screenCoords)
 {
-    if(!m_imageTexture || !screenCoords.isValid())
+    if(!m_imageTexture || m_imageTexture->isEmpty() || !screenCoords.isValid())
         return;
 
     // cache vertex buffers
@@ -192,5 +194,37 @@ void UIWidget::setImageSource(const std::string& source)
         setSize(size);
     }
 
-    m_imageMustRecache = true;
+    updateImageCache();
+}
+
+void UIWidget::setImageSourceAsync(const std::string& source)
+{
+    updateImageCache();
+    if(source.empty()) {
+        m_imageTexture = nullptr;
+        return;
+    }
+
+    // the image is decoded in background, its size is only known once it's uploaded
+    m_imageTexture = g_textures.getTextureAsync(source);
+    bool fitSize = !m_rect.isValid() || m_imageAutoResize;
+    bool fitWidth = fitSize && (getWidth() <= 0 || m_imageAutoResize);
+    bool fitHeight = fitSize && (getHeight() <= 0 || m_imageAutoResize);
+
+    UIWidgetPtr self = static_self_cast<UIWidget>();
+    TexturePtr texture = m_imageTexture;
+    g_textures.whenLoaded(texture, [self, texture, fitWidth, fitHeight] {
+        if(self->isDestroyed() || self->m_imageTexture != texture)
+            return;
+
+        self->m_imageMustRecache = true;
+        if(fitWidth || fitHeight) {
+            Size size = self->getSize();
+            if(fitWidth)
+                size.setWidth(texture->getSize().width());
+            if(fitHeight)
+                size.setHeight(texture->getSize().height());
+            self->setSize(size);
+        }
+    });
 }